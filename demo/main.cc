@@ -225,6 +225,23 @@ PlotTest::PlotTest() :
      x1[i++] = j;
    }
 
+  // error values read in place from interleaved records
+  static struct { double x, y, dx, dy; } rec[7];
+  for (int k = 0; k < 7; k++) {
+    rec[k].x = 60.0 * k;
+    rec[k].y = sin(rec[k].x * M_PI / 180.0);
+    rec[k].dx = 10.0;
+    rec[k].dy = 0.1;
+  }
+  const int stride = sizeof(rec[0]);
+  errCurve->set_raw_data(PlotMM::StridedArray(&rec[0].x, 7, stride),
+      PlotMM::StridedArray(&rec[0].y, 7, stride),
+      PlotMM::StridedArray(&rec[0].dx, 7, stride),
+      PlotMM::StridedArray(&rec[0].dy, 7, stride));
+  if (!errCurve->has_x_errors() || !errCurve->has_y_errors()
+      || errCurve->dx(3) != 10.0 || errCurve->dy(3) != 0.1)
+    std::cerr << "ErrorCurve lost its strided error values" << std::endl;
+
   //errCurve error values.
   //double X1[] = {30.0,40.0,50.0,30.0,40.0,50.0,50.0};
   //double Y1[] = {50.0,60.0,10.0,100.0,30.0,40.0,60.0};
@@ -0,0 +1,115 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "seriesdata.h"
+
+namespace PlotMM {
+
+  /*!
+    Sample types of CompactSeriesData.
+    \sa CompactSeriesData::set_x, CompactSeriesData::set_y
+    */
+  enum SampleType
+  {
+    SAMPLE_DOUBLE,
+    SAMPLE_FLOAT,
+    SAMPLE_INT16,
+    SAMPLE_INT32
+  };
+
+  /*! @brief Series data stored in compact sample types
+   *
+   *  Each axis is stored as double, float, int16 or int32 samples.
+   *  Integer samples typically come straight from an ADC, a scale and
+   *  an offset per axis turn them into values:
+   *  value = sample * scale + offset.
+   *
+   *  The samples are never expanded into doubles for drawing, the
+   *  DoubleIntMap kernels for the sample type map them to pixels
+   *  directly.  A float axis needs half, an int16 axis a quarter of
+   *  the memory of a double axis.
+   *
+   *  \par Example:
+   *  \code
+   *  Glib::RefPtr<CompactSeriesData> data(new CompactSeriesData);
+   *  data->set_x(time, n);
+   *  data->set_y(adc, n, 10.0 / 32768.0, 0.0);   // +-10 V
+   *  curve->set_data(data);
+   *  \endcode
+   */
+  class CompactSeriesData : public SeriesData
+  {
+    public:
+      CompactSeriesData();
+      virtual ~CompactSeriesData();
+
+      void set_x(const double *x, int size);
+      void set_x(const float *x, int size,
+          double scale = 1.0, double offset = 0.0);
+      void set_x(const int16_t *x, int size,
+          double scale = 1.0, double offset = 0.0);
+      void set_x(const int32_t *x, int size,
+          double scale = 1.0, double offset = 0.0);
+
+      void set_y(const double *y, int size);
+      void set_y(const float *y, int size,
+          double scale = 1.0, double offset = 0.0);
+      void set_y(const int16_t *y, int size,
+          double scale = 1.0, double offset = 0.0);
+      void set_y(const int32_t *y, int size,
+          double scale = 1.0, double offset = 0.0);
+
+      //! Return the sample type of the x axis
+      SampleType x_type() const { return x_.type; }
+      //! Return the sample type of the y axis
+      SampleType y_type() const { return y_.type; }
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool transform(const DoubleIntMap &xMap,
+          const DoubleIntMap &yMap, int from, int n,
+          int *xi, int *yi) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+
+    private:
+      //! Samples of one axis, only the vector of the type is used
+      struct Axis
+      {
+        SampleType type;
+        double scale, offset;
+        int size;
+        std::vector<double> d;
+        std::vector<float> f;
+        std::vector<int16_t> s;
+        std::vector<int32_t> l;
+      };
+
+      static void clear_(Axis &a, SampleType type, int size,
+          double scale, double offset);
+      static double value_(const Axis &a, int i);
+      static void fetch_(const Axis &a, int from, int n, double *out);
+      static void transform_(const Axis &a, const DoubleIntMap &map,
+          int from, int n, int *out);
+      static bool bounds_(const Axis &a, double &min, double &max);
+
+      Axis x_;
+      Axis y_;
+  };
+
+} //namespace PlotMM
@@ -3,12 +3,18 @@
 
 #include <gtkmmconfig.h>
 #include <assert.h>
+#include <atomic>
 #include <sigc++/sigc++.h>
 
 //#if (GTKMM_MAJOR_VERSION == 2 && GTKMM_MINOR_VERSION >= 4)
 // TODO: Check if this is relevent, a lot of reference counting
 // going on!
 namespace PlotMM {
+  /* The reference count is atomic, so Glib::RefPtr handles may be
+     copied and released on any thread.  Taking a reference needs no
+     ordering; dropping one is acq_rel, so all use of the object on
+     other threads happens before the last owner deletes it.  The
+     objects themselves and their signals are not made thread safe. */
   class ObjectBase : public sigc::trackable
   {
     protected:
@@ -28,6 +34,9 @@ namespace PlotMM {
 #endif
       {};
 
+      //! Assignment copies no reference count, each object keeps its own
+      ObjectBase &operator=(const ObjectBase &) { return *this; }
+
       virtual ~ObjectBase() {
 #ifdef DEBUG
         is_to_be_deleted();
@@ -36,20 +45,21 @@ namespace PlotMM {
       };
     public:
 
-      void reference() const {_counter++;
+      void reference() const {_counter.fetch_add(1, std::memory_order_relaxed);
 #ifdef DEBUG
         is_valid();
 #endif
       };
 
-      void unreference() const {if (! --_counter) delete this;
+      void unreference() const {
+        if (_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
 #ifdef DEBUG
         else is_valid();mm ObjectBasemm ObjectBasemm ObjectBase
 #endif
       };
 
     private:
-      mutable unsigned int _counter;
+      mutable std::atomic<unsigned int> _counter;
 #ifdef DEBUG
       void is_valid()         const {assert (_counter > 0); assert(_magic == 1234);};
       void is_to_be_deleted() const {assert (_counter == 0); assert(_magic == 1234);};
@@ -0,0 +1,104 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+#include "seriesdata.h"
+#include "minmaxindex.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data compressed in blocks
+   *
+   *  Samples are appended to an open block of block_size() samples.
+   *  Once the block is full it is compressed like in Facebook's
+   *  Gorilla time series store: x values by the delta of deltas of
+   *  their IEEE bit patterns, which is zero or tiny for evenly
+   *  sampled time stamps, and y values by the XOR with the previous
+   *  value, which has few meaningful bits for slowly changing
+   *  signals.  The compression is lossless.  Evenly sampled,
+   *  quantized values like ADC readings take about two bytes per
+   *  sample instead of sixteen; smooth full precision signals still
+   *  take seven or more, since their low mantissa bits all differ.
+   *
+   *  A MinMaxIndex with one level 0 node per block is kept while
+   *  appending.  Curves use it as their level of detail index, so an
+   *  overview is drawn from the block summaries and only the blocks
+   *  of a zoomed in range are decompressed.  The last few
+   *  decompressed blocks are cached.
+   *
+   *  Pointers handed out by CompressedSeriesData::span stay valid
+   *  until the next call to the series.
+   *
+   *  \par Example:
+   *  \code
+   *  Glib::RefPtr<CompressedSeriesData> data(new CompressedSeriesData);
+   *  curve->set_data(data);
+   *  ...
+   *  data->append(t, v, n);
+   *  \endcode
+   *
+   *  \sa MinMaxIndex
+   */
+  class CompressedSeriesData : public SeriesData
+  {
+    public:
+      CompressedSeriesData(int blockSize = 1024, int cacheBlocks = 4);
+      virtual ~CompressedSeriesData();
+
+      void append(const double *x, const double *y, int n);
+      void clear();
+
+      //! Return the number of samples per block
+      int block_size() const { return blockSize_; }
+      size_t memory_used() const;
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+      virtual int monotonic() const;
+      virtual const MinMaxIndex *lod() const;
+
+    private:
+      //! A decompressed block
+      struct Block
+      {
+        int index;
+        std::vector<double> x;
+        std::vector<double> y;
+      };
+
+      CompressedSeriesData(const CompressedSeriesData &);
+      CompressedSeriesData &operator=(const CompressedSeriesData &);
+
+      void compress_();
+      void decompress_(int b, Block &block) const;
+      const Block &block_(int b) const;
+
+      int blockSize_;
+      int cacheBlocks_;
+      int size_;
+
+      std::vector<std::vector<uint64_t> > blocks_;
+      Block open_;
+      mutable std::list<Block> cache_;
+
+      MinMaxIndex index_;
+  };
+
+} //namespace PlotMM
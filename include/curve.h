@@ -10,6 +10,7 @@
 #ifndef PLOTMM_CURVE_H
 #define PLOTMM_CURVE_H
 
+#include <memory>
 #include <vector>
 #include <glibmm/arrayhandle.h>
 #include <glibmm/ustring.h>
@@ -22,6 +23,12 @@
 #include "symbol.h"
 #include "paint.h"
 #include "rectangle.h"
+#include "minmaxindex.h"
+#include "seriesdata.h"
+#include "stridedarray.h"
+#include "sharedaxis.h"
+#include "datablock.h"
+#include "samplequeue.h"
 
 namespace PlotMM {
 
@@ -70,7 +77,12 @@ namespace PlotMM {
    *      <dt>B. Assign or change data.</dt>
    *      <dd>use one of the provided Curve::set_data() functions. The
    *          curve's x and y data are assigned by copying from different
-   *          data structures.</dd>
+   *          data structures. Curve::append() adds samples to the end
+   *          of the data. Uniformly sampled data needs no x values,
+   *          see Curve::set_uniform_data(), curves with the same x
+   *          values can share them in a SharedAxis. Curve::set_raw_data() lets the curve read
+   *          the caller's arrays without copying them, a SeriesData
+   *          can provide the samples from any other storage.</dd>
    *      <dt>C. Draw</dt>
    *      <dd>Curve::draw() maps the data into pixel coordinates and paints
    *          them.  </dd>
@@ -99,9 +111,39 @@ namespace PlotMM {
       virtual void set_data(const double *xData, const double *yData, int size);
       virtual void set_data(const std::vector<double> &xData,
           const std::vector<double> &yData);
+      virtual void set_data(std::vector<double> &&xData,
+          std::vector<double> &&yData);
       virtual void set_data(const Glib::ArrayHandle<Point<double>> &data);
+      virtual void set_raw_data(const double *xData, const double *yData,
+          int size, const sigc::slot<void> &release = sigc::slot<void>());
+      virtual void set_data(const StridedArray &xData,
+          const StridedArray &yData);
+      virtual void set_raw_data(const StridedArray &xData,
+          const StridedArray &yData,
+          const sigc::slot<void> &release = sigc::slot<void>());
+      virtual void set_data(const Glib::RefPtr<SeriesData> &data);
+      Glib::RefPtr<SeriesData> series() const;
+      virtual void set_data(const Glib::RefPtr<SharedAxis> &xData,
+          const std::vector<double> &yData);
+      virtual void set_data(const Glib::RefPtr<SharedAxis> &xData,
+          std::vector<double> &&yData);
+      Glib::RefPtr<SharedAxis> shared_x() const;
+      virtual void set_uniform_data(double x0, double dx,
+          const double *yData, int size);
+      virtual void set_uniform_data(double x0, double dx,
+          std::vector<double> &&yData);
+      bool uniform_x(double &x0, double &dx) const;
+      virtual void append(const double *xData, const double *yData, int size);
+      virtual void append(const double *yData, int size);
+
+      virtual void set_capacity(int n);
+      virtual int capacity() const;
+      void set_queue_capacity(int n);
+      SampleQueue *queue() const;
+      int drain();
 
       virtual int data_size() const;
+      unsigned long data_version() const;
 
       /*!
         \param i index
@@ -109,7 +151,11 @@ namespace PlotMM {
         */
       inline double x(int i) const
       {
-        return x_[i];
+        if (series_)
+          return series_->x(i);
+        if (uniform_)
+          return xStart_ + (xShift_ + i) * xStep_;
+        return xp_[index_(i)];
       }
 
       /*!
@@ -118,11 +164,23 @@ namespace PlotMM {
         */ 
       inline double y(int i) const
       {
-        return y_[i];     
+        return series_ ? series_->y(i) : yp_[index_(i)];
       }
 
+      void fetch(int from, int n, double *x, double *y) const;
+
+      void transform(const DoubleIntMap &xMap, const DoubleIntMap &yMap,
+          int from, int n, int *xi, int *yi) const;
+
       virtual Rect<double> bounding_rect() const;
 
+      virtual void set_log_cache_enabled(bool b);
+      virtual bool log_cache_enabled() const;
+
+      virtual void set_lod_enabled(bool b);
+      virtual bool lod_enabled() const;
+      const MinMaxIndex *lod() const;
+
       inline double min_x_value() const { return bounding_rect().get_x1(); }
       inline double max_x_value() const { return bounding_rect().get_x2(); }
       inline double min_y_value() const { return bounding_rect().get_y1(); }
@@ -184,6 +242,13 @@ namespace PlotMM {
           int from, int to
           );
 
+      virtual void decimate_lines_(
+          const DoubleIntMap &xMap,
+          const DoubleIntMap &yMap,
+          int from, int to,
+          std::vector<Gdk::Point> &polyline
+          ) const;
+
       virtual void draw_sticks_(
           const Cairo::RefPtr<Cairo::Context> &cr,
           const Glib::RefPtr<Gdk::Window> p,
@@ -231,12 +296,54 @@ namespace PlotMM {
           ) const;
 
       virtual void curve_changed();
+      virtual void data_changed();
+      virtual void data_appended(int n);
       virtual int verify_range(int &i1, int &i2);
 
+      int monotonic_x_() const;
+      void visible_range_(const DoubleIntMap &xMap, int &from, int &to) const;
+
     private:
+      //! Return the storage index of sample \a i
+      inline int index_(int i) const
+      {
+        i += head_;
+        return (i < xSize_) ? i : i - xSize_;
+      }
+
+      bool fit_capacity_();
+      void sync_();
+      void own_();
+      void own_x_();
+      void append_(const double *xData, const double *yData, int size);
+      void attach_(const Glib::RefPtr<SeriesData> &data);
+      void attach_x_(const Glib::RefPtr<SharedAxis> &xData);
+      void shared_x_changed_();
+      void release_();
+      void invalidate_();
+      int read_(int from, int n, const double *&x, const double *&y,
+          double *xb, double *yb) const;
+      void evict_(int n);
+      void range_bounds_(int from, int n, double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+
       bool enabled_;
-      std::vector<double> x_;
-      std::vector<double> y_;
+      DataBlock x_;
+      DataBlock y_;
+      const double *xp_;
+      const double *yp_;
+      int xSize_, ySize_;
+      bool borrowed_;
+      sigc::slot<void> release_slot_;
+      Glib::RefPtr<SeriesData> series_;
+      sigc::connection seriesConnection_;
+      Glib::RefPtr<SharedAxis> sharedX_;
+      sigc::connection sharedXConnection_;
+      bool uniform_;
+      double xStart_, xStep_, xShift_;
+      int capacity_;
+      int head_;
+      std::unique_ptr<SampleQueue> queue_;
       CurveStyleID cStyle_;
       double baseline_;
       bool fill_;
@@ -246,6 +353,22 @@ namespace PlotMM {
       Glib::ustring title_;
 
       CurveOptions options_;
+
+      unsigned long version_;
+      mutable unsigned long boundsVersion_;
+      mutable double xMin_, xMax_, yMin_, yMax_;
+
+      bool lodEnabled_;
+      mutable bool lodValid_;
+      mutable MinMaxIndex lod_;
+
+      mutable int mono_;
+      mutable bool monoValid_;
+
+      bool logCacheEnabled_;
+      mutable bool logXValid_, logYValid_;
+      mutable std::vector<double> logX_;
+      mutable std::vector<double> logY_;
   };
 
 } // namespace PlotMM
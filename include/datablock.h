@@ -0,0 +1,102 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace PlotMM {
+
+  /*! @brief An array of doubles shared by copy-on-write
+   *
+   *  Copying a DataBlock only takes another reference to the same
+   *  values, so curves can be copied in constant time however large
+   *  their data is.  The values are copied when one of the holders
+   *  is about to change them, see DataBlock::write.
+   *
+   *  The reference count is atomic.  A copy handed to another thread
+   *  stays unchanged while the original is modified, as long as each
+   *  DataBlock object itself is used by one thread only.
+   *
+   *  \sa Curve::copy
+   */
+  class DataBlock
+  {
+    public:
+      typedef std::vector<double> Vector;
+
+      //! Construct an empty block
+      DataBlock() {}
+      //! Construct a block holding a copy of \a v
+      DataBlock(const Vector &v) : v_(std::make_shared<Vector>(v)) {}
+      //! Construct a block taking over the values of \a v
+      DataBlock(Vector &&v) : v_(std::make_shared<Vector>(std::move(v))) {}
+
+      //! Replace the values by a copy of \a v
+      DataBlock &operator=(const Vector &v)
+      {
+        v_ = std::make_shared<Vector>(v);
+        return *this;
+      }
+
+      //! Replace the values by taking over \a v
+      DataBlock &operator=(Vector &&v)
+      {
+        v_ = std::make_shared<Vector>(std::move(v));
+        return *this;
+      }
+
+      //! Return the number of values
+      int size() const { return v_ ? v_->size() : 0; }
+      //! Return true if there are no values
+      bool empty() const { return size() == 0; }
+      //! Return a pointer to the values
+      const double *data() const { return v_ ? v_->data() : 0; }
+      //! Return value \a i
+      double operator[](int i) const { return (*v_)[i]; }
+      //! Return true if other blocks hold the same values
+      bool shared() const { return v_ && v_.use_count() > 1; }
+
+      //! Drop the values, they are freed with the last holder
+      void clear() { v_.reset(); }
+
+      //! Replace the values by a copy of [first, last)
+      void assign(const double *first, const double *last)
+      {
+        v_ = std::make_shared<Vector>(first, last);
+      }
+
+      /*!
+        \brief Drop the values and return a new empty array to be
+        filled
+        */
+      Vector &replace()
+      {
+        v_ = std::make_shared<Vector>();
+        return *v_;
+      }
+
+      /*!
+        \brief Return the values for modification
+
+        Values held by other blocks as well are copied first.  Pointers
+        returned by DataBlock::data before are invalid afterwards.
+        */
+      Vector &write()
+      {
+        if (!v_)
+          v_ = std::make_shared<Vector>();
+        else if (v_.use_count() > 1)
+          v_ = std::make_shared<Vector>(*v_);
+        return *v_;
+      }
+
+    private:
+      std::shared_ptr<Vector> v_;
+  };
+
+} //namespace PlotMM
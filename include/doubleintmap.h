@@ -10,6 +10,7 @@
 #pragma once
 
 #include <cmath>
+#include <stdint.h>
 #include "supplemental.h"
 
 
@@ -86,10 +87,22 @@ namespace PlotMM {
           return d_y1 + iround((x - d_x1) * d_cnv);
       }
 
+      void transform(const double *x, int *out, int n) const;
+      void transform(const double *x, float *out, int n) const;
+      void transform(const float *x, int *out, int n,
+          double scale = 1.0, double offset = 0.0) const;
+      void transform(const int16_t *x, int *out, int n,
+          double scale = 1.0, double offset = 0.0) const;
+      void transform(const int32_t *x, int *out, int n,
+          double scale = 1.0, double offset = 0.0) const;
+      void log_transform(const double *lx, int *out, int n) const;
+      void uniform_transform(double x0, double dx, int *out, int n) const;
+
       double inv_transform(int i) const;
 
       int lim_transform(double x) const;
       double x_transform(double x) const;
+      void x_transform(const double *x, double *out, int n) const;
 
       /*!
        *  \return the first border of the double interval
@@ -129,6 +142,10 @@ namespace PlotMM {
       }
 
     private:
+      template <class T>
+      void transform_(const T *x, int *out, int n,
+          double scale, double offset) const;
+
       void newFactor();
 
       double d_x1, d_x2;  // double interval boundaries
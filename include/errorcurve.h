@@ -38,14 +38,51 @@ namespace PlotMM {
           int size);
       virtual void set_data(const std::vector<double> &xData,
           const std::vector<double> &yData);
+      virtual void set_data(std::vector<double> &&xData,
+          std::vector<double> &&yData);
       virtual void set_data(const std::vector<double> &xData,
           const std::vector<double> &yData,
           const std::vector<double> &xErr,
           const std::vector<double> &yErr);
       virtual void set_data(const Glib::ArrayHandle<Point<double>> &data);
+      virtual void set_raw_data(const double *xData, const double *yData,
+          int size, const sigc::slot<void> &release = sigc::slot<void>());
+      virtual void set_data(const Glib::RefPtr<SeriesData> &data);
+      virtual void set_data(const Glib::RefPtr<SharedAxis> &xData,
+          const std::vector<double> &yData);
+      virtual void set_data(const Glib::RefPtr<SharedAxis> &xData,
+          std::vector<double> &&yData);
+      virtual void set_data(const Glib::RefPtr<SharedAxis> &xData,
+          const std::vector<double> &yData,
+          const std::vector<double> &xErr,
+          const std::vector<double> &yErr);
+      virtual void set_uniform_data(double x0, double dx,
+          const double *yData, int size);
+      virtual void set_uniform_data(double x0, double dx,
+          std::vector<double> &&yData);
+      virtual void set_data(const StridedArray &xData,
+          const StridedArray &yData);
+      virtual void set_data(const StridedArray &xData,
+          const StridedArray &yData,
+          const StridedArray &xErr,
+          const StridedArray &yErr);
+      virtual void set_raw_data(const StridedArray &xData,
+          const StridedArray &yData,
+          const sigc::slot<void> &release = sigc::slot<void>());
+      virtual void set_raw_data(const StridedArray &xData,
+          const StridedArray &yData,
+          const StridedArray &xErr,
+          const StridedArray &yErr,
+          const sigc::slot<void> &release = sigc::slot<void>());
+
+      virtual void set_capacity(int n);
 
       inline double dx(int i) const;
       inline double dy(int i) const;
+      //! Return true if there is an x error value for every sample
+      bool has_x_errors() const { return have_dx_(); }
+      //! Return true if there is a y error value for every sample
+      bool has_y_errors() const { return have_dy_(); }
 
       virtual Glib::RefPtr<Paint> error_paint() const;
 
@@ -78,15 +115,20 @@ namespace PlotMM {
           int x1, int y1, int x2, int y2);
 
       bool have_dx_() const {
-        return data_size() && (static_cast<int>(dx_.size()) == static_cast<int>(data_size()));
+        return data_size() && (dxp_.size() == data_size());
       }
       bool have_dy_() const {
-        return data_size() && (static_cast<int>(dy_.size()) == static_cast<int>(data_size()));
+        return data_size() && (dyp_.size() == data_size());
       }
     private:
+      void sync_errors_();
+      void drop_capacity_();
+
       Glib::RefPtr<Paint> epaint_;
-      std::vector<double> dx_;
-      std::vector<double> dy_;
+      DataBlock dx_;
+      DataBlock dy_;
+      StridedArray dxp_;
+      StridedArray dyp_;
   };
 
   /*!
@@ -95,7 +137,7 @@ namespace PlotMM {
     */
   inline double ErrorCurve::dx(int i) const
   {
-    return dx_[i];
+    return dxp_[i];
   }
 
   /*!
@@ -104,7 +146,7 @@ namespace PlotMM {
     */
   inline double ErrorCurve::dy(int i) const
   {
-    return dy_[i];
+    return dyp_[i];
   }
 
 }
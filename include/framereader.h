@@ -0,0 +1,110 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <glibmm/main.h>
+
+#include "curve.h"
+
+namespace PlotMM {
+
+  /*! Header of a frame read by FrameReader, followed by \a count x
+   *  values and \a count y values as native doubles.
+   */
+  struct FrameHeader
+  {
+    uint32_t channel;
+    uint32_t count;
+  };
+
+  /*! @brief Feed curves from binary frames on a socket or pipe
+   *
+   *  A FrameReader reads frames of samples from a UNIX domain stream
+   *  socket, a FIFO or any other file descriptor and appends them to
+   *  the curve registered for their channel:
+   *
+   *  \verbatim
+   *  uint32_t channel
+   *  uint32_t count
+   *  double x[count]
+   *  double y[count]
+   *  \endverbatim
+   *
+   *  All fields are in native byte order.  Frames are multiples of
+   *  eight bytes, so the samples are appended straight out of the
+   *  read buffer.
+   *
+   *  The descriptor is watched by the Glib main loop.  Every wakeup
+   *  reads what is available with a single read, dispatches all
+   *  complete frames in it to their curves and emits signal_received
+   *  once, which is where an application calls Plot::replot.  Frames
+   *  for channels without a curve are skipped.  The reader closes on
+   *  end of file, read errors and frames of more than MaxFrameSamples
+   *  samples, and emits signal_closed.
+   *
+   *  \par Example:
+   *  \code
+   *  Glib::RefPtr<FrameReader> reader(new FrameReader);
+   *  reader->set_curve(0, temperature);
+   *  reader->set_curve(1, pressure);
+   *  reader->signal_received.connect(sigc::mem_fun(plot, &Plot::replot));
+   *  reader->connect("/run/daq.sock");
+   *  \endcode
+   */
+  class FrameReader : public PlotMM::ObjectBase
+  {
+    public:
+      //! Largest number of samples in a frame
+      static const uint32_t MaxFrameSamples = 1 << 22;
+
+      FrameReader(size_t bufferSize = 1 << 16);
+      virtual ~FrameReader();
+
+      bool open_fifo(const std::string &path);
+      bool connect(const std::string &path);
+      bool attach(int fd);
+      void close();
+      //! Return true if a descriptor is being read
+      bool is_open() const { return fd_ >= 0; }
+
+      void set_curve(uint32_t channel, const Glib::RefPtr<Curve> &curve);
+      Glib::RefPtr<Curve> curve(uint32_t channel) const;
+
+      //! Return the number of frames dispatched to curves
+      size_t frames() const { return frames_; }
+      //! Return the number of frames skipped for unknown channels
+      size_t skipped() const { return skipped_; }
+
+      //! Emitted once per read that dispatched frames
+      sigc::signal0<void> signal_received;
+      //! Emitted when the reader closes on end of file or an error
+      sigc::signal0<void> signal_closed;
+
+    private:
+      FrameReader(const FrameReader &);
+      FrameReader &operator=(const FrameReader &);
+
+      bool on_io_(Glib::IOCondition condition);
+      bool read_();
+      int dispatch_();
+      void close_(bool notify);
+
+      int fd_;
+      sigc::connection ioConnection_;
+      std::vector<uint64_t> buffer_;
+      size_t fill_;
+      std::map<uint32_t, Glib::RefPtr<Curve> > curves_;
+      size_t frames_;
+      size_t skipped_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,110 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+#include "seriesdata.h"
+#include "stridedarray.h"
+
+namespace PlotMM {
+
+  /*!
+    Access patterns of a MappedSeriesData, passed to the kernel as
+    madvise() hints.
+    \sa MappedSeriesData::set_access
+    */
+  enum MappedAccess
+  {
+    MAPPED_NORMAL,
+    MAPPED_SEQUENTIAL,
+    MAPPED_RANDOM
+  };
+
+  /*! @brief Series data read from a memory mapped file
+   *
+   *  The file is mapped read-only and the samples are read where they
+   *  lie, nothing is loaded up front.  Opening a file of any size is
+   *  immediate, the page cache loads the pages a curve actually
+   *  touches and drops them again under memory pressure.
+   *
+   *  The samples are native doubles.  Two layouts are supported:
+   *  <dl><dt>columnar</dt>
+   *      <dd>all x values followed by all y values, each column at a
+   *          byte offset, see MappedSeriesData::set_columns</dd>
+   *      <dt>records</dt>
+   *      <dd>fixed size records holding x and y among other fields,
+   *          see MappedSeriesData::set_records</dd>
+   *  </dl>
+   *
+   *  Scans over all samples, like SeriesData::bounds, are announced
+   *  to the kernel as sequential, otherwise the hint given with
+   *  MappedSeriesData::set_access applies.  Zoomed views touch few
+   *  pages, MAPPED_RANDOM avoids reading ahead of them.
+   *
+   *  \par Example:
+   *  \code
+   *  Glib::RefPtr<MappedSeriesData> data(new MappedSeriesData);
+   *  if (data->open("recording.bin"))
+   *  {
+   *    data->set_records(64, 24, 0, 8);   // 64 byte header, 3 doubles
+   *    curve->set_data(data);
+   *  }
+   *  \endcode
+   */
+  class MappedSeriesData : public SeriesData
+  {
+    public:
+      MappedSeriesData();
+      virtual ~MappedSeriesData();
+
+      bool open(const std::string &path);
+      void close();
+      //! Return true if a file is mapped
+      bool is_open() const { return map_ != 0; }
+      //! Return the size of the mapped file in bytes
+      size_t file_size() const { return mapSize_; }
+
+      bool set_columns(size_t xOffset, size_t yOffset, int size);
+      bool set_records(size_t offset, int recordSize,
+          int xField, int yField, int size = -1);
+
+      void set_access(MappedAccess access);
+      //! Return the access pattern hint
+      MappedAccess access() const { return access_; }
+      void will_need(int from, int n) const;
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+      virtual int monotonic() const;
+
+    private:
+      MappedSeriesData(const MappedSeriesData &);
+      MappedSeriesData &operator=(const MappedSeriesData &);
+
+      bool fits_(size_t offset, int stride, int size) const;
+      void advise_(MappedAccess access) const;
+      void advise_range_(const StridedArray &a, int from, int n,
+          int advice) const;
+
+      const char *map_;
+      size_t mapSize_;
+      MappedAccess access_;
+      StridedArray x_;
+      StridedArray y_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,106 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+
+namespace PlotMM {
+
+  /*! @brief Multi-resolution min/max index over curve samples
+   *
+   *  The MinMaxIndex keeps a pyramid of block aggregates over a
+   *  series of (x, y) samples.  Level 0 aggregates blocks of
+   *  block_size(0) consecutive samples, every further level merges
+   *  two nodes of the level below.  Each node knows the x and y
+   *  range of its samples, the first and last y value and where the
+   *  y extremes are located, which is all a min/max (M4) decimation
+   *  needs.
+   *
+   *  Samples are added with MinMaxIndex::append, which only touches
+   *  the nodes covering the new samples, so growing a series costs
+   *  O(k + log n) for k new samples.  MinMaxIndex::range answers
+   *  the aggregate over an index range in O(log n).
+   *
+   *  MinMaxIndex::evict drops the oldest samples, which makes the
+   *  index usable for sliding windows.  Sample and node indices are
+   *  absolute: they keep counting from the first sample ever
+   *  appended, MinMaxIndex::first returns the index of the oldest
+   *  sample still present.  Nodes that still aggregate some evicted
+   *  samples are kept until all of their samples are evicted.
+   *
+   *  MinMaxIndex::serialize writes the index to a flat buffer, which
+   *  MinMaxIndex::deserialize restores without looking at the samples.
+   *  The buffer is in native byte order and meant as a cache next to
+   *  the data, see PagedSeriesData::set_sidecar.
+   *
+   *  \sa Curve::set_lod_enabled
+   */
+  class MinMaxIndex
+  {
+    public:
+      //! Aggregate of a block of consecutive samples
+      struct Node
+      {
+        double xmin, xmax;
+        double ymin, ymax;
+        double yfirst, ylast;
+        int imin, imax;     // sample indices of ymin and ymax
+      };
+
+      MinMaxIndex(int blockSize = 64);
+      virtual ~MinMaxIndex();
+
+      void clear();
+      void append(const double *x, const double *y, int n);
+      void evict(int n);
+
+      //! Return the number of indexed samples
+      int size() const { return size_; }
+      //! Return the absolute index of the oldest sample
+      int first() const { return first_; }
+      //! Return the number of levels in the pyramid
+      int levels() const { return levels_.size(); }
+      //! Return the number of samples aggregated by a node of \a level
+      int block_size(int level) const { return 1 << (shift_ + level); }
+      //! Return the index of the first node on \a level
+      int first_node(int level) const { return offsets_[level]; }
+      //! Return the index past the last node on \a level
+      int end_node(int level) const
+      { return offsets_[level] + levels_[level].size(); }
+      //! Return node \a j of \a level
+      const Node &node(int level, int j) const
+      { return levels_[level][j - offsets_[level]]; }
+
+      int level_for(int samples) const;
+      int monotonic() const;
+
+      Node range(int a, int b, int level = 0) const;
+      Node root() const;
+
+      size_t serialized_size() const;
+      void serialize(char *out) const;
+      bool deserialize(const char *in, size_t bytes);
+
+      static Node empty_node();
+      static void merge(Node &n, const Node &m);
+
+    private:
+      void update_levels_(int j0);
+      void rebase_();
+
+      int shift_;
+      int first_;
+      int size_;
+      int mono_;
+      double xlast_;
+      std::vector<std::deque<Node> > levels_;
+      std::vector<int> offsets_;
+  };
+
+} //namespace PlotMM
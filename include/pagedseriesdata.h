@@ -0,0 +1,132 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "seriesdata.h"
+#include "minmaxindex.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data read in pages from a file larger than memory
+   *
+   *  The samples stay in the file and are read in pages of
+   *  page_size() samples when a curve needs them.  Loaded pages are
+   *  kept in a least recently used cache, which is trimmed to the
+   *  memory budget whenever a page is loaded.
+   *
+   *  When the layout is set, the file is scanned once and a
+   *  MinMaxIndex of per-block summaries is built.  Curves use it as
+   *  their level of detail index: an overview is drawn from the
+   *  summaries alone, zooming in reads only the pages of the visible
+   *  range.  The summaries need 64 bytes per \a summaryBlock samples
+   *  plus the same again for the coarser levels.
+   *
+   *  Building the summaries of a huge file takes as long as reading
+   *  it.  With PagedSeriesData::set_sidecar, the summaries are stored
+   *  in a sidecar file after they were built and are loaded from it
+   *  the next time the same file is opened with the same layout.  The
+   *  sidecar is memory mapped and only used if the size, modification
+   *  time, first and last page of the data and its own contents still
+   *  match the hash recorded in it.
+   *
+   *  The file layout is the one of MappedSeriesData: two columns of
+   *  native doubles or fixed size records.
+   *
+   *  Pointers handed out by PagedSeriesData::span stay valid until the
+   *  next call to the series.
+   *
+   *  \sa MappedSeriesData, MinMaxIndex
+   */
+  class PagedSeriesData : public SeriesData
+  {
+    public:
+      PagedSeriesData(int pageSize = 65536, int summaryBlock = 1024);
+      virtual ~PagedSeriesData();
+
+      bool open(const std::string &path);
+      void close();
+      //! Return true if a file is open
+      bool is_open() const { return fd_ >= 0; }
+
+      bool set_columns(size_t xOffset, size_t yOffset, int size);
+      bool set_records(size_t offset, int recordSize,
+          int xField, int yField, int size = -1);
+
+      void set_sidecar(const std::string &path);
+      //! Return the path of the sidecar file, empty if not used
+      const std::string &sidecar() const { return sidecar_; }
+      //! Return true if the summaries were loaded from the sidecar
+      bool sidecar_loaded() const { return sidecarLoaded_; }
+
+      void set_memory_budget(size_t bytes);
+      //! Return the memory budget of the page cache in bytes
+      size_t memory_budget() const { return budget_; }
+      size_t memory_used() const;
+      //! Return the number of samples per page
+      int page_size() const { return pageSize_; }
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+      virtual int monotonic() const;
+      virtual const MinMaxIndex *lod() const;
+
+    private:
+      //! A page of samples
+      struct Page
+      {
+        int index;
+        std::vector<double> x;
+        std::vector<double> y;
+      };
+
+      PagedSeriesData(const PagedSeriesData &);
+      PagedSeriesData &operator=(const PagedSeriesData &);
+
+      bool set_layout_(size_t xOffset, size_t yOffset, int stride, int size);
+      void build_summary_();
+      bool load_summary_();
+      bool save_summary_() const;
+      uint64_t hash_(const void *header, size_t headerSize,
+          const char *summary, size_t bytes) const;
+      bool read_page_(int p, Page &page) const;
+      const Page &page_(int p) const;
+      void trim_() const;
+
+      int fd_;
+      size_t fileSize_;
+      long long mtime_, mtimeNsec_;
+      size_t xOffset_, yOffset_;
+      int stride_;
+      int size_;
+      int pageSize_;
+
+      size_t budget_;
+      mutable std::list<Page> pages_;
+      mutable std::unordered_map<int, std::list<Page>::iterator> lookup_;
+      mutable std::vector<char> records_;
+
+      MinMaxIndex summary_;
+      std::string sidecar_;
+      bool sidecarLoaded_;
+  };
+
+} //namespace PlotMM
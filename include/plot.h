@@ -147,6 +147,8 @@ namespace PlotMM
       virtual void draw_selection_();
 
     private:
+      void drain_curves_();
+
       Cairo::RefPtr<Cairo::Pattern> pattern_;
       int loop;
       double alpha;
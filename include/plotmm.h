@@ -18,6 +18,21 @@
 #include "scalediv.h"
 #include "curve.h"
 #include "errorcurve.h"
+#include "minmaxindex.h"
+#include "seriesdata.h"
+#include "compactseriesdata.h"
+#include "compressedseriesdata.h"
+#include "stridedarray.h"
+#include "stridedseriesdata.h"
+#include "mappedseriesdata.h"
+#include "pagedseriesdata.h"
+#include "rollupseriesdata.h"
+#include "snapshotseriesdata.h"
+#include "shmseriesdata.h"
+#include "framereader.h"
+#include "sharedaxis.h"
+#include "datablock.h"
+#include "samplequeue.h"
 #include "symbol.h"
 #include "paint.h"
 #include "rectangle.h"
@@ -0,0 +1,122 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "seriesdata.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data with raw samples and coarser rollup tiers
+   *
+   *  Like a round robin database, RollupSeriesData keeps the raw
+   *  samples of the last \a rawSpan x units only.  Every tier added
+   *  with RollupSeriesData::add_tier consolidates all appended samples
+   *  into buckets of a fixed width, keeping the minimum, maximum and
+   *  mean of each, and forgets buckets older than its own span.  The
+   *  memory needed is bounded by the spans and stays flat however
+   *  long a stream runs.
+   *
+   *  The samples served are those of the resolution selected with
+   *  RollupSeriesData::set_resolution, which Curve::draw calls with
+   *  the x distance of one pixel: the coarsest tier whose buckets are
+   *  not wider than a pixel, or the raw samples if there is none.
+   *  Older data that the selected resolution does not cover anymore
+   *  comes from the next coarser tiers.  A bucket is served as two
+   *  samples, its minimum and maximum in the order they occurred.
+   *
+   *  x values must not decrease, appended samples that go back in x
+   *  or have a NaN x are dropped.
+   *
+   *  \par Example:
+   *  \code
+   *  // 10 minutes raw, 1 s for a day, 1 min for a month, 1 h for 5 years
+   *  Glib::RefPtr<RollupSeriesData> data(new RollupSeriesData(600));
+   *  data->add_tier(1, 86400);
+   *  data->add_tier(60, 30 * 86400);
+   *  data->add_tier(3600, 5 * 365 * 86400);
+   *  curve->set_data(data);
+   *  \endcode
+   */
+  class RollupSeriesData : public SeriesData
+  {
+    public:
+      //! Consolidated samples of a bucket
+      struct Bucket
+      {
+        double start;       // x of the bucket start
+        double low, high;   // y minimum and maximum
+        double xLow, xHigh; // x of the minimum and the maximum
+        double sum;         // y sum
+        int count;          // number of samples
+
+        //! Return the mean of the y values
+        double mean() const { return sum / count; }
+      };
+
+      RollupSeriesData(double rawSpan);
+      virtual ~RollupSeriesData();
+
+      void add_tier(double width, double span);
+      //! Return the number of tiers
+      int tiers() const { return tiers_.size(); }
+      //! Return the bucket width of \a tier
+      double tier_width(int tier) const { return tiers_[tier].width; }
+      //! Return the number of buckets in \a tier
+      int tier_size(int tier) const { return tiers_[tier].buckets.size(); }
+      //! Return bucket \a i of \a tier, the oldest first
+      const Bucket &bucket(int tier, int i) const
+      { return tiers_[tier].buckets[i]; }
+      //! Return the number of raw samples
+      int raw_size() const { return rawX_.size(); }
+
+      void append(const double *x, const double *y, int n);
+      void clear();
+
+      //! Return the tier served, -1 for the raw samples
+      int resolution() const { return resolution_; }
+      virtual bool set_resolution(double dx);
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+      virtual int monotonic() const;
+
+    private:
+      //! A rollup tier
+      struct Tier
+      {
+        double width;
+        double span;
+        std::deque<Bucket> buckets;
+      };
+
+      //! Consecutive samples served from one tier
+      struct Segment
+      {
+        int tier;           // -1 for the raw samples
+        int first;          // index of the first sample of the tier
+        int size;           // number of samples
+      };
+
+      void add_(double x, double y);
+      void update_segments_();
+      void sample_(int i, double &x, double &y) const;
+
+      double rawSpan_;
+      std::deque<double> rawX_, rawY_;
+      std::vector<Tier> tiers_;
+
+      int resolution_;
+      int size_;
+      std::vector<Segment> segments_;
+  };
+
+} //namespace PlotMM
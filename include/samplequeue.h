@@ -0,0 +1,67 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+
+namespace PlotMM {
+
+  /*! @brief Lock-free queue of samples from one thread to another
+   *
+   *  A SampleQueue is a ring buffer of (x, y) samples with a single
+   *  producer and a single consumer.  The producer, typically an
+   *  acquisition thread, adds samples with SampleQueue::push, the
+   *  consumer, the GUI thread, takes them out with SampleQueue::pop
+   *  or SampleQueue::span and SampleQueue::consume.  Neither side
+   *  takes a lock or waits for the other: samples pushed while the
+   *  queue is full are dropped and counted.
+   *
+   *  The positions of both sides live on cache lines of their own,
+   *  and each side keeps a private copy of the other side's position
+   *  that it only refreshes when the queue looks full or empty.
+   *
+   *  \sa Curve::set_queue_capacity, Curve::drain
+   */
+  class SampleQueue
+  {
+    public:
+      SampleQueue(int capacity);
+      ~SampleQueue();
+
+      //! Return the number of samples the queue holds at most
+      int capacity() const { return mask_ + 1; }
+
+      int push(const double *x, const double *y, int n);
+      int pop(double *x, double *y, int n);
+      int span(const double *&x, const double *&y);
+      void consume(int n);
+
+      int size() const;
+      //! Return the number of samples dropped because the queue was full
+      size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+      SampleQueue(const SampleQueue &);
+      SampleQueue &operator=(const SampleQueue &);
+
+      std::vector<double> x_;
+      std::vector<double> y_;
+      size_t mask_;
+
+      // written by the consumer
+      alignas(64) std::atomic<size_t> head_;
+      size_t tailCache_;
+
+      // written by the producer
+      alignas(64) std::atomic<size_t> tail_;
+      size_t headCache_;
+      std::atomic<size_t> dropped_;
+  };
+
+} //namespace PlotMM
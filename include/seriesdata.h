@@ -0,0 +1,83 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <sigc++/sigc++.h>
+
+#include "compat.h"
+
+namespace PlotMM {
+
+  class MinMaxIndex;
+  class DoubleIntMap;
+
+  /*! @brief Abstract source of curve samples
+   *
+   *  SeriesData decouples a Curve from the storage of its samples.
+   *  An implementation only has to report its size and copy a range
+   *  of consecutive samples with SeriesData::fetch.  Curves read the
+   *  samples in chunks of a few hundred, so one virtual call serves
+   *  many samples.
+   *
+   *  Implementations that keep the samples as arrays of doubles can
+   *  hand out pointers into them with SeriesData::span, which saves
+   *  the copy.  Sources that do not store doubles can map their
+   *  samples to pixels themselves with SeriesData::transform.
+   *  Sources that know more about their samples can
+   *  override SeriesData::bounds, SeriesData::monotonic and
+   *  SeriesData::lod, the defaults scan the samples.  Sources that
+   *  keep their samples in several resolutions select one with
+   *  SeriesData::set_resolution.  Sources written by other threads
+   *  take in their changes in SeriesData::update.
+   *
+   *  Implementations must emit signal_changed whenever their samples
+   *  change, attached curves then drop everything they derived from
+   *  the samples.
+   *
+   *  \sa Curve::set_data(const Glib::RefPtr<SeriesData> &)
+   */
+  class SeriesData : public PlotMM::ObjectBase
+  {
+    public:
+      SeriesData();
+      virtual ~SeriesData();
+
+      //! Return the number of samples
+      virtual int size() const = 0;
+
+      /*!
+        \brief Copy the samples [from, from + n)
+        \param from index of the first sample
+        \param n number of samples
+        \param x receives n x values
+        \param y receives n y values
+        */
+      virtual void fetch(int from, int n, double *x, double *y) const = 0;
+
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool transform(const DoubleIntMap &xMap,
+          const DoubleIntMap &yMap, int from, int n,
+          int *xi, int *yi) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+      virtual int monotonic() const;
+      virtual const MinMaxIndex *lod() const;
+
+      virtual bool set_resolution(double dx);
+      virtual bool update();
+
+      //! Emitted when the samples have changed
+      sigc::signal0<void> signal_changed;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,70 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <vector>
+
+#include "compat.h"
+#include "doubleintmap.h"
+
+namespace PlotMM {
+
+  /*! @brief Axis values shared by several curves
+   *
+   *  Multichannel displays often draw many curves over the same
+   *  timestamps.  A SharedAxis holds these values once, every curve
+   *  given the axis with Curve::set_data(const Glib::RefPtr<SharedAxis> &,
+   *  const std::vector<double> &) references it instead of keeping a
+   *  copy.
+   *
+   *  The axis also caches the pixel coordinates of its values for the
+   *  map it was last asked for.  The first curve drawn in a frame maps
+   *  the visible values, the other curves reuse the result.
+   *
+   *  Changes of the values must go through SharedAxis::set_values,
+   *  which notifies the curves with signal_changed.
+   *
+   *  \sa Curve::shared_x
+   */
+  class SharedAxis : public PlotMM::ObjectBase
+  {
+    public:
+      SharedAxis();
+      SharedAxis(const double *values, int size);
+      SharedAxis(std::vector<double> &&values);
+      virtual ~SharedAxis();
+
+      void set_values(const double *values, int size);
+      void set_values(std::vector<double> &&values);
+
+      //! Return the number of values
+      int size() const { return values_.size(); }
+      //! Return a pointer to the values
+      const double *data() const { return values_.data(); }
+      //! Return value \a i
+      double operator[](int i) const { return values_[i]; }
+
+      const int *pixels(const DoubleIntMap &map, int from, int n) const;
+
+      //! Emitted when the values have changed
+      sigc::signal0<void> signal_changed;
+
+    private:
+      SharedAxis(const SharedAxis &);
+      SharedAxis &operator=(const SharedAxis &);
+
+      void changed_();
+
+      std::vector<double> values_;
+
+      mutable std::vector<int> pixels_;
+      mutable bool pixelsValid_;
+      mutable DoubleIntMap pixelsMap_;
+      mutable int pixelsFrom_, pixelsTo_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,99 @@
+/* -*- mode: C ; c-file-style: "stroustrup" -*- *******************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#ifndef PLOTMM_SHMRING_H
+#define PLOTMM_SHMRING_H
+
+/*! \file shmring.h
+ *  \brief Layout of a shared memory sample ring and its C writer
+ *
+ *  A sample ring is a POSIX shared memory object created with
+ *  shm_open.  It starts with a struct plotmm_shm_header of
+ *  PLOTMM_SHM_HEADER_SIZE bytes, followed by \a capacity x values
+ *  and \a capacity y values, all native doubles:
+ *
+ *  \verbatim
+ *  offset                          contents
+ *  0                               struct plotmm_shm_header
+ *  PLOTMM_SHM_HEADER_SIZE          double x[capacity]
+ *  + 8 * capacity                  double y[capacity]
+ *  \endverbatim
+ *
+ *  Sample \a i of the stream is stored in slot i % capacity.
+ *  \a write_index counts the samples written since the last reset.
+ *  The writer stores the samples first and then advances
+ *  \a write_index with release semantics; readers load it with
+ *  acquire semantics, after which all samples below it are visible.
+ *  \a generation is incremented whenever the writer resets the
+ *  stream, after \a write_index is cleared, which tells readers to
+ *  drop what they have shown.
+ *
+ *  The writer never waits for readers and does not know about them.
+ *  It overwrites the oldest slots whether or not a reader shows
+ *  them.  Readers leave the oldest slots out of what they show, see
+ *  PlotMM::ShmSeriesData::set_headroom; a writer that runs further
+ *  ahead than that before the samples are drawn tears them, which
+ *  readers only detect afterwards, see
+ *  PlotMM::ShmSeriesData::overruns.
+ *
+ *  \par Writer example:
+ *  \code
+ *  struct plotmm_shm_ring *ring = plotmm_shm_create("/daq0", 1 << 20);
+ *  for (;;)
+ *  {
+ *    n = acquire(t, v);
+ *    plotmm_shm_write(ring, t, v, n);
+ *  }
+ *  plotmm_shm_close(ring, "/daq0");
+ *  \endcode
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "PMMR" */
+#define PLOTMM_SHM_MAGIC 0x524d4d50u
+#define PLOTMM_SHM_VERSION 1u
+#define PLOTMM_SHM_HEADER_SIZE 64u
+
+/*! Header at the start of a sample ring */
+struct plotmm_shm_header
+{
+  uint32_t magic;         /* PLOTMM_SHM_MAGIC */
+  uint32_t version;       /* PLOTMM_SHM_VERSION */
+  uint32_t capacity;      /* number of slots, a power of two */
+  uint32_t header_size;   /* PLOTMM_SHM_HEADER_SIZE, offset of x */
+  uint64_t generation;    /* incremented by every reset */
+  uint64_t write_index;   /* samples written since the last reset */
+  uint8_t reserved[32];
+};
+
+/*! Writer side of a sample ring */
+struct plotmm_shm_ring
+{
+  int fd;
+  size_t size;
+  struct plotmm_shm_header *header;
+  double *x;
+  double *y;
+};
+
+size_t plotmm_shm_size(uint32_t capacity);
+struct plotmm_shm_ring *plotmm_shm_create(const char *name, uint32_t capacity);
+void plotmm_shm_write(struct plotmm_shm_ring *ring,
+    const double *x, const double *y, uint32_t n);
+void plotmm_shm_reset(struct plotmm_shm_ring *ring);
+void plotmm_shm_close(struct plotmm_shm_ring *ring, const char *unlinkName);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,101 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "seriesdata.h"
+#include "shmring.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data read from a shared memory sample ring
+   *
+   *  ShmSeriesData attaches to a sample ring that another process
+   *  writes with the C helpers of shmring.h.  The ring is mapped read
+   *  only and curves draw straight from the shared pages, nothing is
+   *  copied and no system call is made per sample.
+   *
+   *  The samples served are fixed in ShmSeriesData::update, which
+   *  Curve::drain calls in every Plot::replot: the most recent
+   *  samples of the ring up to its capacity less the headroom.  The
+   *  writer may add up to headroom samples before it overwrites any
+   *  of them, so the headroom has to cover what the writer produces
+   *  until the plot is drawn.  The writer does not wait for readers:
+   *  if it runs further ahead, the samples drawn may be torn.  This
+   *  is detected in the next update and counted in
+   *  ShmSeriesData::overruns.
+   *
+   *  A reset of the stream by the writer is picked up in the next
+   *  update.  A ring re-created with another capacity is detached
+   *  from in the next update, and has to be opened again.
+   *
+   *  \par Example:
+   *  \code
+   *  Glib::RefPtr<ShmSeriesData> data(new ShmSeriesData);
+   *  if (data->open("/daq0"))
+   *    curve->set_data(data);
+   *  // then replot periodically
+   *  \endcode
+   *
+   *  \sa plotmm_shm_create, plotmm_shm_write
+   */
+  class ShmSeriesData : public SeriesData
+  {
+    public:
+      ShmSeriesData();
+      virtual ~ShmSeriesData();
+
+      bool open(const std::string &name);
+      void close();
+      //! Return true if a ring is attached
+      bool is_open() const { return header_ != 0; }
+
+      void set_headroom(int n);
+      //! Return the number of slots kept clear for the writer
+      int headroom() const { return headroom_; }
+      //! Return the number of slots of the ring
+      int capacity() const { return capacity_; }
+      //! Return the generation of the stream served
+      uint64_t generation() const { return generation_; }
+      //! Return the number of windows the writer overwrote while served
+      unsigned long overruns() const { return overruns_; }
+
+      virtual bool update();
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+    private:
+      ShmSeriesData(const ShmSeriesData &);
+      ShmSeriesData &operator=(const ShmSeriesData &);
+
+      //! Return the slot of sample \a i
+      size_t slot_(int i) const { return (first_ + i) & (capacity_ - 1); }
+
+      int fd_;
+      size_t mapSize_;
+      const plotmm_shm_header *header_;
+      const double *x_;
+      const double *y_;
+      int capacity_;
+      int headroom_;
+
+      uint64_t generation_;
+      uint64_t first_;
+      int count_;
+      unsigned long overruns_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,97 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "seriesdata.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data published as immutable snapshots by other threads
+   *
+   *  Writer threads build a complete set of samples and hand it over
+   *  with SnapshotSeriesData::publish.  The GUI thread picks up the
+   *  latest snapshot in SnapshotSeriesData::update, which Curve::drain
+   *  calls in every Plot::replot, and reads only that snapshot until the next
+   *  update.  A render therefore always sees consistent samples.
+   *
+   *  Snapshots change hands through atomic pointer exchanges, so a
+   *  snapshot is owned by exactly one side at any time and is never
+   *  freed while the other side reads it.  Neither side takes a lock
+   *  or waits: a writer that publishes faster than the GUI updates
+   *  replaces the snapshot that was not picked up yet.  Retired
+   *  snapshots are handed back to the writers for reuse, so at steady
+   *  state publishing allocates no memory.
+   *
+   *  Bounds and monotony are computed by the writer while it
+   *  publishes, which keeps the scans off the GUI thread.
+   *
+   *  Writer threads must have finished before the SnapshotSeriesData
+   *  is destroyed.
+   *
+   *  \par Example:
+   *  \code
+   *  // acquisition thread
+   *  data->publish(x, y, n);
+   *
+   *  // GUI thread
+   *  curve->set_data(data);
+   *  plot->replot();
+   *  \endcode
+   */
+  class SnapshotSeriesData : public SeriesData
+  {
+    public:
+      SnapshotSeriesData();
+      virtual ~SnapshotSeriesData();
+
+      void publish(const double *x, const double *y, int size);
+      void publish(std::vector<double> &&x, std::vector<double> &&y);
+
+      virtual bool update();
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+      virtual bool bounds(double &xmin, double &xmax,
+          double &ymin, double &ymax) const;
+      virtual int monotonic() const;
+
+    private:
+      //! An immutable set of samples
+      struct Snapshot
+      {
+        std::vector<double> x;
+        std::vector<double> y;
+        double xmin, xmax, ymin, ymax;
+        bool valid;
+        int mono;
+      };
+
+      SnapshotSeriesData(const SnapshotSeriesData &);
+      SnapshotSeriesData &operator=(const SnapshotSeriesData &);
+
+      Snapshot *acquire_();
+      void publish_(Snapshot *s);
+      void recycle_(Snapshot *s);
+
+      // owned by the GUI thread
+      Snapshot *current_;
+      // published, not picked up yet
+      std::atomic<Snapshot *> latest_;
+      // retired, for reuse by a writer
+      std::atomic<Snapshot *> spare_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,107 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+namespace PlotMM {
+
+  /*! @brief A view of doubles that are spaced by a fixed number of
+   *  bytes
+   *
+   *  A StridedArray refers to \a size doubles starting at \a base,
+   *  each \a stride bytes after the previous one.  It can describe a
+   *  plain array as well as one field of an array of structs, so that
+   *  interleaved records can be read in place:
+   *
+   *  \code
+   *  struct Record { double time, value, error; int flags; };
+   *
+   *  StridedArray t(&rec[0].time, n, sizeof(Record));
+   *  StridedArray v(&rec[0].value, n, sizeof(Record));
+   *  curve->set_raw_data(t, v);
+   *  \endcode
+   *
+   *  The view does not own the memory.
+   *
+   *  \sa Curve::set_raw_data(const StridedArray &, const StridedArray &,
+   *  const sigc::slot<void> &), StridedSeriesData
+   */
+  class StridedArray
+  {
+    public:
+      //! Construct an empty view
+      StridedArray()
+        : base_(0), size_(0), stride_(sizeof(double)) {}
+
+      /*!
+        \param base pointer to the first value
+        \param size number of values
+        \param stride distance of the values in bytes
+        */
+      StridedArray(const double *base, int size,
+          int stride = sizeof(double))
+        : base_(reinterpret_cast<const char *>(base)),
+          size_(base ? size : 0), stride_(stride) {}
+
+      //! Return the number of values
+      int size() const { return size_; }
+      //! Return the distance of the values in bytes
+      int stride() const { return stride_; }
+      //! Return true if the values are consecutive doubles
+      bool contiguous() const { return stride_ == sizeof(double); }
+      //! Return a pointer to the first value
+      const double *data() const
+      {
+        return reinterpret_cast<const double *>(base_);
+      }
+
+      //! Return value \a i
+      double operator[](int i) const
+      {
+        const char *p = base_ + i * static_cast<long>(stride_);
+        return *reinterpret_cast<const double *>(p);
+      }
+
+      /*!
+        \brief Copy the values [from, from + n) into consecutive doubles
+        \param from index of the first value
+        \param n number of values
+        \param out receives n values
+        */
+      void copy(int from, int n, double *out) const
+      {
+        if (contiguous())
+        {
+          const double *p = data() + from;
+          std::copy(p, p + n, out);
+          return;
+        }
+
+        const char *p = base_ + from * static_cast<long>(stride_);
+        for (int i = 0; i < n; i++, p += stride_)
+          out[i] = *reinterpret_cast<const double *>(p);
+      }
+
+      /*!
+        \brief Copy all values into a vector
+        \param v receives the values, its capacity is reserved once
+        */
+      void copy(std::vector<double> &v) const
+      {
+        v.resize(size_);
+        copy(0, size_, v.data());
+      }
+
+    private:
+      const char *base_;
+      int size_;
+      int stride_;
+  };
+
+} //namespace PlotMM
@@ -0,0 +1,60 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+#pragma once
+
+#include "seriesdata.h"
+#include "stridedarray.h"
+
+namespace PlotMM {
+
+  /*! @brief Series data read in place from strided or interleaved
+   *  memory
+   *
+   *  The x and y values are read through two StridedArray views, for
+   *  example two fields of an array of structs.  Nothing is copied
+   *  when the data is set, the curve gathers the values in chunks
+   *  while drawing.  Contiguous views are handed out directly with
+   *  SeriesData::span.
+   *
+   *  The memory must stay valid and unchanged while the series
+   *  exists.  The release slot is called when the series is
+   *  destroyed, which is when the last curve drops it.  Changes of
+   *  the memory must be announced with signal_changed.
+   *
+   *  \sa Curve::set_raw_data(const StridedArray &, const StridedArray &,
+   *  const sigc::slot<void> &)
+   */
+  class StridedSeriesData : public SeriesData
+  {
+    public:
+      StridedSeriesData(const StridedArray &x, const StridedArray &y,
+          const sigc::slot<void> &release = sigc::slot<void>());
+      virtual ~StridedSeriesData();
+
+      //! Return the view of the x values
+      const StridedArray &x_array() const { return x_; }
+      //! Return the view of the y values
+      const StridedArray &y_array() const { return y_; }
+
+      virtual int size() const;
+      virtual void fetch(int from, int n, double *x, double *y) const;
+      virtual int span(int from, int n,
+          const double *&x, const double *&y) const;
+
+      virtual double x(int i) const;
+      virtual double y(int i) const;
+
+    private:
+      StridedSeriesData(const StridedSeriesData &);
+      StridedSeriesData &operator=(const StridedSeriesData &);
+
+      StridedArray x_;
+      StridedArray y_;
+      sigc::slot<void> release_;
+  };
+
+} //namespace PlotMM
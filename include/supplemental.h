@@ -15,16 +15,20 @@ namespace PlotMM {
 
   double ceil_125(double x);
   double floor_125(double x);
-  double array_min (double *array, int size);
-  double array_max( double *array, int size);
+  double array_min(const double *array, int size);
+  double array_max(const double *array, int size);
+  bool array_min_max(const double *array, int size, double &min, double &max);
+  bool array_bounds(const double *x, const double *y, int size,
+      double &xmin, double &xmax, double &ymin, double &ymax);
   void twist_array(double *array, int size);
   void twist_array(std::vector<double> &);
-  int check_mono(double *array, int size);
+  int check_mono(const double *array, int size);
   void lin_space(double *array, int size, double xmin, double xmax);
   void log_space(double *array, int size, double xmin, double xmax);
   void lin_space(std::vector<double>&,int size,double xmin,double xmax);
   void log_space(std::vector<double>&,int size,double xmin,double xmax);
   void vector_from_c(std::vector<double> &array,const double *c, int size);
+  void log_array(const double *array, double *out, int size);
 
   extern const double LogMin;
   extern const double LogMax;
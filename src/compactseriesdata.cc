@@ -0,0 +1,324 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "supplemental.h"
+#include "doubleintmap.h"
+#include "compactseriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    /* min/max of raw samples, NaN values are skipped */
+    template <class T>
+    bool raw_min_max(const T *p, int n, double &min, double &max)
+    {
+      T lo = 0, hi = 0;
+      bool valid = false;
+      for (int i = 0; i < n; i++)
+      {
+        if (p[i] != p[i])
+          continue;
+        if (!valid)
+        {
+          lo = hi = p[i];
+          valid = true;
+        }
+        if (p[i] < lo) lo = p[i];
+        if (p[i] > hi) hi = p[i];
+      }
+      min = lo;
+      max = hi;
+      return valid;
+    }
+
+    template <class T>
+    void convert(const T *p, int n, double scale, double offset,
+        double *out)
+    {
+      for (int i = 0; i < n; i++)
+        out[i] = p[i] * scale + offset;
+    }
+
+  }
+
+  //! Constructor, both axes are empty double axes
+  CompactSeriesData::CompactSeriesData()
+  {
+    clear_(x_, SAMPLE_DOUBLE, 0, 1.0, 0.0);
+    clear_(y_, SAMPLE_DOUBLE, 0, 1.0, 0.0);
+  }
+
+  //! Destructor
+  CompactSeriesData::~CompactSeriesData()
+  {
+  }
+
+  //! Drop the samples of an axis and set its type
+  void CompactSeriesData::clear_(Axis &a, SampleType type, int size,
+      double scale, double offset)
+  {
+    a.type = type;
+    a.scale = scale;
+    a.offset = offset;
+    a.size = std::max(size, 0);
+    std::vector<double>().swap(a.d);
+    std::vector<float>().swap(a.f);
+    std::vector<int16_t>().swap(a.s);
+    std::vector<int32_t>().swap(a.l);
+  }
+
+  /*!
+    \brief Set the x values by copying them
+    \param x pointer to the x values
+    \param size number of values
+    */
+  void CompactSeriesData::set_x(const double *x, int size)
+  {
+    clear_(x_, SAMPLE_DOUBLE, size, 1.0, 0.0);
+    x_.d.assign(x, x + x_.size);
+    signal_changed();
+  }
+
+  /*!
+    \brief Set the x values by copying compact samples
+    \param x pointer to the samples
+    \param size number of samples
+    \param scale the value of a sample is sample * scale + offset
+    \param offset see scale
+    */
+  void CompactSeriesData::set_x(const float *x, int size,
+      double scale, double offset)
+  {
+    clear_(x_, SAMPLE_FLOAT, size, scale, offset);
+    x_.f.assign(x, x + x_.size);
+    signal_changed();
+  }
+
+  //! \copydoc CompactSeriesData::set_x(const float *, int, double, double)
+  void CompactSeriesData::set_x(const int16_t *x, int size,
+      double scale, double offset)
+  {
+    clear_(x_, SAMPLE_INT16, size, scale, offset);
+    x_.s.assign(x, x + x_.size);
+    signal_changed();
+  }
+
+  //! \copydoc CompactSeriesData::set_x(const float *, int, double, double)
+  void CompactSeriesData::set_x(const int32_t *x, int size,
+      double scale, double offset)
+  {
+    clear_(x_, SAMPLE_INT32, size, scale, offset);
+    x_.l.assign(x, x + x_.size);
+    signal_changed();
+  }
+
+  /*!
+    \brief Set the y values by copying them
+    \param y pointer to the y values
+    \param size number of values
+    */
+  void CompactSeriesData::set_y(const double *y, int size)
+  {
+    clear_(y_, SAMPLE_DOUBLE, size, 1.0, 0.0);
+    y_.d.assign(y, y + y_.size);
+    signal_changed();
+  }
+
+  /*!
+    \brief Set the y values by copying compact samples
+    \param y pointer to the samples
+    \param size number of samples
+    \param scale the value of a sample is sample * scale + offset
+    \param offset see scale
+    */
+  void CompactSeriesData::set_y(const float *y, int size,
+      double scale, double offset)
+  {
+    clear_(y_, SAMPLE_FLOAT, size, scale, offset);
+    y_.f.assign(y, y + y_.size);
+    signal_changed();
+  }
+
+  //! \copydoc CompactSeriesData::set_y(const float *, int, double, double)
+  void CompactSeriesData::set_y(const int16_t *y, int size,
+      double scale, double offset)
+  {
+    clear_(y_, SAMPLE_INT16, size, scale, offset);
+    y_.s.assign(y, y + y_.size);
+    signal_changed();
+  }
+
+  //! \copydoc CompactSeriesData::set_y(const float *, int, double, double)
+  void CompactSeriesData::set_y(const int32_t *y, int size,
+      double scale, double offset)
+  {
+    clear_(y_, SAMPLE_INT32, size, scale, offset);
+    y_.l.assign(y, y + y_.size);
+    signal_changed();
+  }
+
+  //! Return the number of samples, the size of the shorter axis
+  int CompactSeriesData::size() const
+  {
+    return std::min(x_.size, y_.size);
+  }
+
+  //! Return the value of sample \a i of an axis
+  double CompactSeriesData::value_(const Axis &a, int i)
+  {
+    switch (a.type)
+    {
+      case SAMPLE_FLOAT:
+        return a.f[i] * a.scale + a.offset;
+      case SAMPLE_INT16:
+        return a.s[i] * a.scale + a.offset;
+      case SAMPLE_INT32:
+        return a.l[i] * a.scale + a.offset;
+      default:
+        return a.d[i];
+    }
+  }
+
+  //! Convert the samples [from, from + n) of an axis to values
+  void CompactSeriesData::fetch_(const Axis &a, int from, int n, double *out)
+  {
+    switch (a.type)
+    {
+      case SAMPLE_FLOAT:
+        convert(a.f.data() + from, n, a.scale, a.offset, out);
+        break;
+      case SAMPLE_INT16:
+        convert(a.s.data() + from, n, a.scale, a.offset, out);
+        break;
+      case SAMPLE_INT32:
+        convert(a.l.data() + from, n, a.scale, a.offset, out);
+        break;
+      default:
+        std::copy(a.d.data() + from, a.d.data() + from + n, out);
+        break;
+    }
+  }
+
+  //! Map the samples [from, from + n) of an axis to pixels
+  void CompactSeriesData::transform_(const Axis &a, const DoubleIntMap &map,
+      int from, int n, int *out)
+  {
+    switch (a.type)
+    {
+      case SAMPLE_FLOAT:
+        map.transform(a.f.data() + from, out, n, a.scale, a.offset);
+        break;
+      case SAMPLE_INT16:
+        map.transform(a.s.data() + from, out, n, a.scale, a.offset);
+        break;
+      case SAMPLE_INT32:
+        map.transform(a.l.data() + from, out, n, a.scale, a.offset);
+        break;
+      default:
+        map.transform(a.d.data() + from, out, n);
+        break;
+    }
+  }
+
+  //! Find the smallest and the largest value of an axis
+  bool CompactSeriesData::bounds_(const Axis &a, double &min, double &max)
+  {
+    bool valid;
+    switch (a.type)
+    {
+      case SAMPLE_FLOAT:
+        valid = raw_min_max(a.f.data(), a.size, min, max);
+        break;
+      case SAMPLE_INT16:
+        valid = raw_min_max(a.s.data(), a.size, min, max);
+        break;
+      case SAMPLE_INT32:
+        valid = raw_min_max(a.l.data(), a.size, min, max);
+        break;
+      default:
+        return array_min_max(a.d.data(), a.size, min, max);
+    }
+
+    // extremes of the samples are extremes of the values
+    min = min * a.scale + a.offset;
+    max = max * a.scale + a.offset;
+    sort_values(min, max);
+    return valid;
+  }
+
+  //! \copydoc SeriesData::fetch
+  void CompactSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    fetch_(x_, from, n, x);
+    fetch_(y_, from, n, y);
+  }
+
+  /*!
+    \brief Give direct access to consecutive samples
+
+    Only possible if both axes store doubles.
+    \sa SeriesData::span
+    */
+  int CompactSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    if (x_.type != SAMPLE_DOUBLE || y_.type != SAMPLE_DOUBLE)
+      return 0;
+
+    x = x_.d.data() + from;
+    y = y_.d.data() + from;
+    return std::min(n, size() - from);
+  }
+
+  //! Return the x value of sample \a i
+  double CompactSeriesData::x(int i) const
+  {
+    return value_(x_, i);
+  }
+
+  //! Return the y value of sample \a i
+  double CompactSeriesData::y(int i) const
+  {
+    return value_(y_, i);
+  }
+
+  /*!
+    \brief Map the samples [from, from + n) into pixel coordinates
+    with the kernels for the sample types
+    \sa DoubleIntMap::transform(const int16_t *, int *, int, double, double) const
+    */
+  bool CompactSeriesData::transform(const DoubleIntMap &xMap,
+      const DoubleIntMap &yMap, int from, int n, int *xi, int *yi) const
+  {
+    transform_(x_, xMap, from, n, xi);
+    transform_(y_, yMap, from, n, yi);
+    return true;
+  }
+
+  /*!
+    \brief Find the bounds of the samples
+
+    The extremes are searched among the raw samples, only two values
+    per axis are converted.
+    \sa SeriesData::bounds
+    */
+  bool CompactSeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    if (x_.size != y_.size)
+      return SeriesData::bounds(xmin, xmax, ymin, ymax);
+
+    const bool vx = bounds_(x_, xmin, xmax);
+    const bool vy = bounds_(y_, ymin, ymax);
+    return vx && vy;
+  }
+
+} //namespace PlotMM
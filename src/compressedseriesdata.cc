@@ -0,0 +1,381 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include "compressedseriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    uint64_t to_bits(double v)
+    {
+      uint64_t b;
+      memcpy(&b, &v, sizeof(b));
+      return b;
+    }
+
+    double from_bits(uint64_t b)
+    {
+      double v;
+      memcpy(&v, &b, sizeof(v));
+      return v;
+    }
+
+    /* Appends bit fields to words, most significant bit first */
+    class BitWriter
+    {
+      public:
+        BitWriter(std::vector<uint64_t> &words) : words_(words), bits_(0) {}
+
+        void put(uint64_t v, int n)
+        {
+          if (n < 64)
+            v &= (uint64_t(1) << n) - 1;
+          const int off = bits_ & 63;
+          if (off == 0)
+            words_.push_back(0);
+          const int room = 64 - off;
+          if (n <= room)
+            words_.back() |= v << (room - n);
+          else
+          {
+            words_.back() |= v >> (n - room);
+            words_.push_back(v << (64 - (n - room)));
+          }
+          bits_ += n;
+        }
+
+      private:
+        std::vector<uint64_t> &words_;
+        size_t bits_;
+    };
+
+    /* Reads the bit fields written by BitWriter */
+    class BitReader
+    {
+      public:
+        BitReader(const std::vector<uint64_t> &words)
+          : words_(words), pos_(0) {}
+
+        uint64_t get(int n)
+        {
+          const int off = pos_ & 63;
+          const size_t w = pos_ >> 6;
+          const int room = 64 - off;
+          pos_ += n;
+          if (n <= room)
+            return (words_[w] << off) >> (64 - n);
+          return ((words_[w] << off) >> off) << (n - room)
+            | words_[w + 1] >> (64 - (n - room));
+        }
+
+      private:
+        const std::vector<uint64_t> &words_;
+        size_t pos_;
+    };
+
+    /* Size classes of the delta of deltas: prefix, prefix length and
+       number of bits of the zigzag encoded value */
+    const struct { uint64_t prefix; int length, bits; } DeltaClasses[] = {
+      { 0x2, 2, 7 }, { 0x6, 3, 9 }, { 0xe, 4, 12 }, { 0xf, 4, 64 }
+    };
+
+  }
+
+  /*!
+    \brief Constructor
+    \param blockSize number of samples per compressed block, rounded up
+    to a power of two
+    \param cacheBlocks number of decompressed blocks kept
+    */
+  CompressedSeriesData::CompressedSeriesData(int blockSize, int cacheBlocks)
+    : blockSize_(0), cacheBlocks_(std::max(cacheBlocks, 1)), size_(0),
+      index_(std::max(blockSize, 2))
+  {
+    blockSize_ = index_.block_size(0);
+    open_.index = 0;
+  }
+
+  //! Destructor
+  CompressedSeriesData::~CompressedSeriesData()
+  {
+  }
+
+  /*!
+    \brief Append samples
+    \param x pointer to x values
+    \param y pointer to y values
+    \param n number of samples
+    */
+  void CompressedSeriesData::append(const double *x, const double *y, int n)
+  {
+    if (n <= 0)
+      return;
+
+    index_.append(x, y, n);
+    for (int i = 0, k; i < n; i += k)
+    {
+      k = std::min(n - i, blockSize_ - static_cast<int>(open_.x.size()));
+      open_.x.insert(open_.x.end(), x + i, x + i + k);
+      open_.y.insert(open_.y.end(), y + i, y + i + k);
+      if (static_cast<int>(open_.x.size()) == blockSize_)
+        compress_();
+    }
+    size_ += n;
+
+    signal_changed();
+  }
+
+  //! Remove all samples
+  void CompressedSeriesData::clear()
+  {
+    blocks_.clear();
+    open_.index = 0;
+    open_.x.clear();
+    open_.y.clear();
+    cache_.clear();
+    index_.clear();
+    size_ = 0;
+
+    signal_changed();
+  }
+
+  /*!
+    \brief Return the memory used by the samples in bytes
+
+    This includes the compressed blocks, the open block and the cache
+    of decompressed blocks, but not the MinMaxIndex.
+    */
+  size_t CompressedSeriesData::memory_used() const
+  {
+    size_t bytes = 2 * sizeof(double) * open_.x.capacity();
+    for (unsigned int b = 0; b < blocks_.size(); b++)
+      bytes += sizeof(uint64_t) * blocks_[b].capacity();
+    for (std::list<Block>::const_iterator it = cache_.begin();
+         it != cache_.end(); ++it)
+      bytes += 2 * sizeof(double) * it->x.capacity();
+    return bytes;
+  }
+
+  /*!
+    \brief Compress the open block, which is full
+
+    The first sample is stored as is.  x values follow as the delta
+    of deltas of their bit patterns, y values as the XOR with their
+    predecessor, stored as the meaningful bits within the window of
+    the previous XOR if they fit, or with a new window otherwise.
+    */
+  void CompressedSeriesData::compress_()
+  {
+    blocks_.push_back(std::vector<uint64_t>());
+    std::vector<uint64_t> &words = blocks_.back();
+    BitWriter out(words);
+
+    uint64_t px = to_bits(open_.x[0]), py = to_bits(open_.y[0]);
+    out.put(px, 64);
+    out.put(py, 64);
+
+    uint64_t delta = 0;
+    int lead = -1, trail = 0;
+    for (int i = 1; i < blockSize_; i++)
+    {
+      const uint64_t bx = to_bits(open_.x[i]);
+      const int64_t dod = static_cast<int64_t>((bx - px) - delta);
+      const uint64_t z = (static_cast<uint64_t>(dod) << 1)
+        ^ static_cast<uint64_t>(dod >> 63);
+      if (z == 0)
+        out.put(0, 1);
+      else
+      {
+        int c = 0;
+        while (DeltaClasses[c].bits < 64 && (z >> DeltaClasses[c].bits))
+          c++;
+        out.put(DeltaClasses[c].prefix, DeltaClasses[c].length);
+        out.put(z, DeltaClasses[c].bits);
+      }
+      delta = bx - px;
+      px = bx;
+
+      const uint64_t by = to_bits(open_.y[i]);
+      const uint64_t v = by ^ py;
+      py = by;
+      if (v == 0)
+      {
+        out.put(0, 1);
+        continue;
+      }
+
+      const int l = __builtin_clzll(v), t = __builtin_ctzll(v);
+      if (lead >= 0 && l >= lead && t >= trail)
+      {
+        out.put(0x2, 2);
+        out.put(v >> trail, 64 - lead - trail);
+      }
+      else
+      {
+        lead = l;
+        trail = t;
+        out.put(0x3, 2);
+        out.put(lead, 6);
+        out.put(63 - lead - trail, 6);
+        out.put(v >> trail, 64 - lead - trail);
+      }
+    }
+    std::vector<uint64_t>(words).swap(words);
+
+    open_.index = blocks_.size();
+    open_.x.clear();
+    open_.y.clear();
+  }
+
+  //! Decompress block \a b into \a block
+  void CompressedSeriesData::decompress_(int b, Block &block) const
+  {
+    BitReader in(blocks_[b]);
+    block.index = b;
+    block.x.resize(blockSize_);
+    block.y.resize(blockSize_);
+
+    uint64_t px = in.get(64), py = in.get(64);
+    block.x[0] = from_bits(px);
+    block.y[0] = from_bits(py);
+
+    uint64_t delta = 0;
+    int lead = 0, trail = 0;
+    for (int i = 1; i < blockSize_; i++)
+    {
+      if (in.get(1))
+      {
+        int c = 0;
+        while (c < 3 && in.get(1))
+          c++;
+        const uint64_t z = in.get(DeltaClasses[c].bits);
+        delta += (z >> 1) ^ (~(z & 1) + 1);
+      }
+      px += delta;
+      block.x[i] = from_bits(px);
+
+      if (in.get(1))
+      {
+        if (in.get(1))
+        {
+          lead = in.get(6);
+          trail = 63 - lead - static_cast<int>(in.get(6));
+        }
+        py ^= in.get(64 - lead - trail) << trail;
+      }
+      block.y[i] = from_bits(py);
+    }
+  }
+
+  /*!
+    \brief Return block \a b, decompressing it if necessary
+
+    The open block is returned directly.
+    */
+  const CompressedSeriesData::Block &CompressedSeriesData::block_(int b) const
+  {
+    if (b == static_cast<int>(blocks_.size()))
+      return open_;
+
+    for (std::list<Block>::iterator it = cache_.begin();
+         it != cache_.end(); ++it)
+    {
+      if (it->index == b)
+      {
+        cache_.splice(cache_.begin(), cache_, it);
+        return cache_.front();
+      }
+    }
+
+    if (static_cast<int>(cache_.size()) >= cacheBlocks_)
+      cache_.splice(cache_.begin(), cache_, --cache_.end());
+    else
+      cache_.push_front(Block());
+    decompress_(b, cache_.front());
+    return cache_.front();
+  }
+
+  //! Return the number of samples
+  int CompressedSeriesData::size() const
+  {
+    return size_;
+  }
+
+  //! \copydoc SeriesData::fetch
+  void CompressedSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const Block &block = block_(i / blockSize_);
+      const int o = i % blockSize_;
+      k = std::min(from + n - i, static_cast<int>(block.x.size()) - o);
+      std::copy(block.x.begin() + o, block.x.begin() + o + k, x + i - from);
+      std::copy(block.y.begin() + o, block.y.begin() + o + k, y + i - from);
+    }
+  }
+
+  /*!
+    \brief Give direct access to the samples of a decompressed block
+    \sa SeriesData::span
+    */
+  int CompressedSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    const Block &block = block_(from / blockSize_);
+    const int o = from % blockSize_;
+    x = block.x.data() + o;
+    y = block.y.data() + o;
+    return std::min(n, static_cast<int>(block.x.size()) - o);
+  }
+
+  //! Return the x value of sample \a i
+  double CompressedSeriesData::x(int i) const
+  {
+    return block_(i / blockSize_).x[i % blockSize_];
+  }
+
+  //! Return the y value of sample \a i
+  double CompressedSeriesData::y(int i) const
+  {
+    return block_(i / blockSize_).y[i % blockSize_];
+  }
+
+  /*!
+    \brief Return the bounds from the block summaries
+    \sa SeriesData::bounds
+    */
+  bool CompressedSeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    if (size_ == 0)
+      return false;
+
+    const MinMaxIndex::Node r = index_.root();
+    xmin = r.xmin;
+    xmax = r.xmax;
+    ymin = r.ymin;
+    ymax = r.ymax;
+    return xmin <= xmax && ymin <= ymax;
+  }
+
+  //! Return the monotony of x from the block summaries
+  int CompressedSeriesData::monotonic() const
+  {
+    return index_.monotonic();
+  }
+
+  //! Return the block summaries as level of detail index
+  const MinMaxIndex *CompressedSeriesData::lod() const
+  {
+    return &index_;
+  }
+
+} //namespace PlotMM
@@ -8,13 +8,24 @@
 /* ported from qwt */
 
 #include <glibmm/refptr.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <utility>
 
 #include "plotmm.h"
 #include "doubleintmap.h"
 
 namespace PlotMM {
 
+  namespace {
+
+    // Samples are read and transformed in chunks of this size by the
+    // draw functions, which keeps the buffers on the stack.
+    const int DrawChunk = 512;
+
+  }
+
   //! Initialize data members
   void Curve::init(const Glib::ustring &title)
   {
@@ -25,9 +36,31 @@ namespace PlotMM {
     cStyle_ = CURVE_LINES;
     paint_ = Glib::RefPtr<Paint> (new Paint);
     symbol_ = Glib::RefPtr<Symbol> (new Symbol);
+    lodEnabled_ = false;
+    lodValid_ = false;
+    monoValid_ = false;
+    mono_ = 0;
+    logCacheEnabled_ = false;
+    logXValid_ = logYValid_ = false;
+    version_ = 1;
+    boundsVersion_ = 0;
+    capacity_ = 0;
+    head_ = 0;
+    borrowed_ = false;
+    uniform_ = false;
+    xStart_ = 0.0;
+    xStep_ = 1.0;
+    xShift_ = 0.0;
+    sync_();
   }
 
-  //! Copy the contents of a curve into another curve
+  /*!
+    \brief Copy the contents of a curve into another curve
+
+    The samples are held in DataBlocks and are shared with \a c until
+    one of the curves changes them, so copying takes constant time.
+    Samples referenced with Curve::set_raw_data are copied.
+    */
   void Curve::copy(const Curve &c)
   {
     enabled_ = c.enabled_;
@@ -38,13 +71,60 @@ namespace PlotMM {
     cStyle_ = c.cStyle_;
 
     options_ = c.options_;
-    x_ = c.x_;
-    y_ = c.y_;
+    release_();
+    uniform_ = c.uniform_;
+    xStart_ = c.xStart_;
+    xStep_ = c.xStep_;
+    xShift_ = c.xShift_;
+    if (c.series_)
+    {
+      x_.clear();
+      y_.clear();
+      attach_(c.series_);
+    }
+    else
+    {
+      // owned samples are shared until one of the curves changes
+      // them, referenced samples are copied
+      if (uniform_)
+        x_.clear();
+      else if (c.sharedX_)
+      {
+        x_.clear();
+        attach_x_(c.sharedX_);
+      }
+      else if (c.borrowed_)
+        x_.assign(c.xp_, c.xp_ + c.xSize_);
+      else
+        x_ = c.x_;
+      if (c.borrowed_)
+        y_.assign(c.yp_, c.yp_ + c.ySize_);
+      else
+        y_ = c.y_;
+    }
+    sync_();
+    capacity_ = c.capacity_;
+    head_ = c.head_;
+    lodEnabled_ = c.lodEnabled_;
+    lodValid_ = false;
+    logCacheEnabled_ = c.logCacheEnabled_;
+    logXValid_ = logYValid_ = false;
+
+    // what is cheap to take over is kept, the rest is rebuilt on use
+    version_++;
+    mono_ = c.mono_;
+    monoValid_ = c.monoValid_;
+    xMin_ = c.xMin_;
+    xMax_ = c.xMax_;
+    yMin_ = c.yMin_;
+    yMax_ = c.yMax_;
+    boundsVersion_ = (c.boundsVersion_ == c.version_) ? version_ : version_ - 1;
   }
 
   //! Destructor
   Curve::~Curve()
   {
+    release_();
   }
 
   /*!
@@ -66,6 +146,7 @@ namespace PlotMM {
   //! Copy Assignment
   const Curve& Curve::operator=(const Curve &c)
   {
+    // copy() replaces the data and keeps what was derived from it
     if (this != &c)
     {
       copy(c);
@@ -159,9 +240,14 @@ namespace PlotMM {
     */
   void Curve::set_data(const double *xData, const double *yData, int size)
   {
-    vector_from_c(x_, xData,size);
-    vector_from_c(y_, yData,size);
-    curve_changed();
+    release_();
+    uniform_ = false;
+    vector_from_c(x_.replace(), xData,size);
+    vector_from_c(y_.replace(), yData,size);
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
   }
 
   /*!
@@ -170,97 +256,1269 @@ namespace PlotMM {
     \param xData x data
     \param yData y data
 
-    @todo handle unevenly sized arrays correctly
-    */
-  void Curve::set_data(const std::vector<double> &xData,
-      const std::vector<double> &yData)
-  {
+    @todo handle unevenly sized arrays correctly
+    */
+  void Curve::set_data(const std::vector<double> &xData,
+      const std::vector<double> &yData)
+  {
+
+    release_();
+    uniform_ = false;
+    x_ = xData;
+    y_ = yData;
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Initialize data with x- and y-arrays by moving them into
+    the curve
+
+    No samples are copied.
+
+    \param xData x data
+    \param yData y data
+    */
+  void Curve::set_data(std::vector<double> &&xData,
+      std::vector<double> &&yData)
+  {
+    release_();
+    uniform_ = false;
+    x_ = std::move(xData);
+    y_ = std::move(yData);
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Set data by referencing the caller's memory blocks
+
+    Contrary to Curve::set_data, the samples are not copied.  The
+    curve reads \a xData and \a yData directly until it is given new
+    data or destroyed, then \a release is called.  The arrays must stay
+    valid and unchanged until then.
+
+    Curve::append copies the referenced samples into the curve first,
+    a capacity only narrows the referenced range.  A copy of the curve
+    owns a copy of the samples.
+
+    \param xData pointer to x values
+    \param yData pointer to y values
+    \param size size of xData and yData
+    \param release called when the curve stops referencing the arrays
+    */
+  void Curve::set_raw_data(const double *xData, const double *yData,
+      int size, const sigc::slot<void> &release)
+  {
+    release_();
+    uniform_ = false;
+    x_.clear();
+    y_.clear();
+
+    xp_ = xData;
+    yp_ = yData;
+    xSize_ = ySize_ = std::max(size, 0);
+    borrowed_ = true;
+    release_slot_ = release;
+
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+  /*!
+    Initialize data with an array of points (explicitly shared).
+
+    \param data Data
+
+    @todo test if this method really works
+    */
+  void Curve::set_data(const Glib::ArrayHandle<Point<double>> &data)
+  {
+    release_();
+    uniform_ = false;
+    std::vector<double> &xv = x_.replace(), &yv = y_.replace();
+    xv.resize(data.size());
+    yv.resize(data.size());
+    Glib::ArrayHandle<Point<double>>::const_iterator daPnt(data.begin());
+    for (int i = 0; daPnt != data.end(); ++daPnt, ++i) {
+      const Point<double> p = *daPnt;
+      xv[i] = p.get_x();
+      yv[i] = p.get_y();
+    }
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Set data by copying the values of strided or interleaved
+    arrays
+
+    Each axis is gathered into the curve's arrays in a single pass.
+
+    \param xData view of the x values
+    \param yData view of the y values
+    \sa StridedArray
+    */
+  void Curve::set_data(const StridedArray &xData, const StridedArray &yData)
+  {
+    release_();
+    uniform_ = false;
+    xData.copy(x_.replace());
+    yData.copy(y_.replace());
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Set data by referencing strided or interleaved arrays
+
+    Like Curve::set_raw_data(const double *, const double *, int,
+    const sigc::slot<void> &), the values are not copied.  Views with
+    gaps between the values are read through a StridedSeriesData,
+    which gathers them in chunks while drawing.
+
+    \param xData view of the x values
+    \param yData view of the y values
+    \param release called when the curve stops referencing the arrays
+    \sa StridedArray, StridedSeriesData
+    */
+  void Curve::set_raw_data(const StridedArray &xData,
+      const StridedArray &yData, const sigc::slot<void> &release)
+  {
+    // not virtual, overrides like ErrorCurve's drop their own data
+    if (xData.contiguous() && yData.contiguous())
+    {
+      Curve::set_raw_data(xData.data(), yData.data(),
+          std::min(xData.size(), yData.size()), release);
+      return;
+    }
+
+    Curve::set_data(Glib::RefPtr<SeriesData>(
+          new StridedSeriesData(xData, yData, release)));
+  }
+
+  /*!
+    \brief Set data with x values shared with other curves
+
+    The curve references \a xData instead of copying the x values
+    and follows its changes.  While drawing, the pixel coordinates of
+    the x values are taken from the cache of the axis, so they are
+    computed once for all curves sharing it.  A copy of the curve
+    shares the axis as well.  Curve::append and a capacity smaller
+    than the data give the curve its own copy of the x values.
+
+    \param xData shared x values
+    \param yData y values
+    \sa SharedAxis
+    */
+  void Curve::set_data(const Glib::RefPtr<SharedAxis> &xData,
+      const std::vector<double> &yData)
+  {
+    release_();
+    uniform_ = false;
+    x_.clear();
+    y_ = yData;
+    attach_x_(xData);
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Set data with x values shared with other curves, moving
+    the y values into the curve
+    \sa Curve::set_data(const Glib::RefPtr<SharedAxis> &,
+    const std::vector<double> &)
+    */
+  void Curve::set_data(const Glib::RefPtr<SharedAxis> &xData,
+      std::vector<double> &&yData)
+  {
+    release_();
+    uniform_ = false;
+    x_.clear();
+    y_ = std::move(yData);
+    attach_x_(xData);
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Return the shared x values of the curve, if any
+    \sa Curve::set_data(const Glib::RefPtr<SharedAxis> &,
+    const std::vector<double> &)
+    */
+  Glib::RefPtr<SharedAxis> Curve::shared_x() const
+  {
+    return sharedX_;
+  }
+
+  /*!
+    \brief Read the samples from a SeriesData
+
+    The curve keeps a reference to \a data and reads the samples in
+    chunks whenever it needs them.  It follows changes announced by
+    SeriesData::signal_changed.  Curve::append copies the samples into
+    the curve first, a capacity does not apply.  Logarithmic data is
+    not cached for series data.
+
+    \param data source of the samples
+    \sa SeriesData
+    */
+  void Curve::set_data(const Glib::RefPtr<SeriesData> &data)
+  {
+    release_();
+    uniform_ = false;
+    x_.clear();
+    y_.clear();
+    sync_();
+    head_ = 0;
+
+    attach_(data);
+    data_changed();
+  }
+
+  /*!
+    \brief Return the SeriesData the curve reads from, if any
+    \sa Curve::set_data(const Glib::RefPtr<SeriesData> &)
+    */
+  Glib::RefPtr<SeriesData> Curve::series() const
+  {
+    return series_;
+  }
+
+  /*!
+    \brief Set uniformly sampled data by copying the y values
+
+    The x value of sample i is x0 + i * dx, no x values are stored.
+    Looking up the visible samples takes constant time and only the
+    y values are read when drawing.  Curve::append(const double *, int)
+    continues the data, the x values of evicted samples are skipped.
+
+    \param x0 x value of the first sample
+    \param dx distance of the samples, must not be 0
+    \param yData pointer to y values
+    \param size number of samples
+    \sa Curve::uniform_x
+    */
+  void Curve::set_uniform_data(double x0, double dx,
+      const double *yData, int size)
+  {
+    release_();
+    uniform_ = true;
+    xStart_ = x0;
+    xStep_ = dx;
+    xShift_ = 0.0;
+    x_.clear();
+    vector_from_c(y_.replace(), yData, size);
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Set uniformly sampled data by moving the y values into the
+    curve
+    \sa Curve::set_uniform_data(double, double, const double *, int)
+    */
+  void Curve::set_uniform_data(double x0, double dx,
+      std::vector<double> &&yData)
+  {
+    release_();
+    uniform_ = true;
+    xStart_ = x0;
+    xStep_ = dx;
+    xShift_ = 0.0;
+    x_.clear();
+    y_ = std::move(yData);
+    sync_();
+    head_ = 0;
+    fit_capacity_();
+    data_changed();
+  }
+
+  /*!
+    \brief Check if the x values are implicit
+    \param x0 receives the x value of the first sample
+    \param dx receives the distance of the samples
+    \return true if the data was set with Curve::set_uniform_data
+    */
+  bool Curve::uniform_x(double &x0, double &dx) const
+  {
+    if (!uniform_)
+      return false;
+
+    x0 = x(0);
+    dx = xStep_;
+    return true;
+  }
+
+  /*!
+    \brief Copy the samples [from, from + n)
+    \param from index of the first sample
+    \param n number of samples
+    \param x receives n x values
+    \param y receives n y values
+    */
+  void Curve::fetch(int from, int n, double *x, double *y) const
+  {
+    if (series_)
+    {
+      series_->fetch(from, n, x, y);
+      return;
+    }
+
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const int p = index_(i);
+      k = std::min(from + n - i, xSize_ - p);
+      if (uniform_)
+      {
+        for (int j = i; j < i + k; j++)
+          x[j - from] = xStart_ + (xShift_ + j) * xStep_;
+      }
+      else
+        std::copy(xp_ + p, xp_ + p + k, x + i - from);
+      std::copy(yp_ + p, yp_ + p + k, y + i - from);
+    }
+  }
+
+  /*!
+    \brief Append samples to the curve's data
+
+    The bounds, the level of detail index and the log cache are
+    extended by the new samples instead of being rebuilt, so appending
+    k samples costs O(k).
+
+    If a capacity is set and the data is full, the new samples
+    overwrite the oldest ones in place.  The data is then kept as a
+    ring buffer and is never moved.
+
+    \param xData pointer to x values
+    \param yData pointer to y values
+    \param size number of samples to append
+
+    \sa Curve::set_data, Curve::set_capacity, Curve::data_appended
+    */
+  void Curve::append(const double *xData, const double *yData, int size)
+  {
+    if (size <= 0)
+      return;
+
+    own_x_();
+    append_(xData, yData, size);
+  }
+
+  /*!
+    \brief Append samples to uniformly sampled data
+
+    The x values continue the data set with Curve::set_uniform_data.
+    Curves with explicit x values are not changed.
+
+    \param yData pointer to y values
+    \param size number of samples to append
+    \sa Curve::append(const double *, const double *, int)
+    */
+  void Curve::append(const double *yData, int size)
+  {
+    if (size <= 0 || !uniform_)
+      return;
+
+    append_(0, yData, size);
+  }
+
+  /*!
+    \brief Append samples, \a xData is not read for uniform data
+    \sa Curve::append
+    */
+  void Curve::append_(const double *xData, const double *yData, int size)
+  {
+    if (capacity_ > 0 && size >= capacity_)
+    {
+      // nothing of the old data is kept
+      const int dropped = data_size() + size - capacity_;
+      release_();
+      if (uniform_)
+        xShift_ += dropped;
+      else
+        x_.assign(xData + size - capacity_, xData + size);
+      y_.assign(yData + size - capacity_, yData + size);
+      sync_();
+      head_ = 0;
+      data_changed();
+      return;
+    }
+
+    own_();
+    if (xSize_ != ySize_)
+    {
+      std::vector<double> &xv = x_.write(), &yv = y_.write();
+      xv.insert(xv.end(), xData, xData + size);
+      yv.insert(yv.end(), yData, yData + size);
+      sync_();
+      fit_capacity_();
+      data_changed();
+      return;
+    }
+
+    // fill up to the capacity, then replace the oldest samples
+    int n = size;
+    if (capacity_ > 0)
+      n = std::min(size, capacity_ - static_cast<int>(y_.size()));
+    if (!uniform_)
+    {
+      std::vector<double> &xv = x_.write();
+      xv.insert(xv.end(), xData, xData + n);
+    }
+    std::vector<double> &yv = y_.write();
+    yv.insert(yv.end(), yData, yData + n);
+    sync_();
+
+    const int m = size - n;
+    if (m > 0)
+    {
+      evict_(m);
+      double *xw = uniform_ ? 0 : x_.write().data();
+      double *yw = y_.write().data();
+      for (int i = 0; i < m; i++)
+      {
+        if (xw)
+          xw[head_] = xData[n + i];
+        yw[head_] = yData[n + i];
+        if (++head_ == capacity_)
+          head_ = 0;
+      }
+      if (uniform_)
+        xShift_ += m;
+    }
+
+    data_appended(size);
+  }
+
+  /*!
+    \brief Limit the number of samples
+
+    With a capacity of \a n the curve keeps only the \a n most recent
+    samples.  Curve::append then evicts the oldest samples instead of
+    growing the data, and Curve::set_data keeps the end of the new
+    data.  ErrorCurve ignores the capacity while it has error values.
+
+    \param n maximum number of samples, or 0 for no limit
+    \sa Curve::capacity, Curve::append
+    */
+  void Curve::set_capacity(int n)
+  {
+    // wrapped data is always the curve's own
+    bool changed = false;
+    if (head_ != 0)
+    {
+      if (!uniform_)
+      {
+        std::vector<double> &xv = x_.write();
+        std::rotate(xv.begin(), xv.begin() + head_, xv.end());
+      }
+      std::vector<double> &yv = y_.write();
+      std::rotate(yv.begin(), yv.begin() + head_, yv.end());
+      head_ = 0;
+      sync_();
+      changed = true;
+    }
+
+    capacity_ = std::max(n, 0);
+    if (fit_capacity_() || changed)
+      data_changed();
+  }
+
+  /*!
+    \brief Return the maximum number of samples, 0 means no limit
+    \sa Curve::set_capacity
+    */
+  int Curve::capacity() const
+  {
+    return capacity_;
+  }
+
+  /*!
+    \brief Create a queue for samples from another thread
+
+    The samples pushed to Curve::queue are appended by Curve::drain,
+    which Plot::replot calls before it autoscales, unless the curve
+    shows a SeriesData.  Samples still queued are lost when the queue
+    is replaced.
+
+    \param n number of samples the queue holds, 0 removes the queue
+    \sa SampleQueue
+    */
+  void Curve::set_queue_capacity(int n)
+  {
+    queue_.reset(n > 0 ? new SampleQueue(n) : 0);
+  }
+
+  /*!
+    \brief Return the queue for samples from another thread
+
+    The queue belongs to the curve.  A producer thread may push to it
+    as long as the curve exists and the queue is not replaced.
+
+    \return the queue, or 0 if there is none
+    \sa Curve::set_queue_capacity
+    */
+  SampleQueue *Curve::queue() const
+  {
+    return queue_.get();
+  }
+
+  /*!
+    \brief Append the samples queued so far
+
+    Samples are appended in place from the queue, at most two blocks
+    at a time.  Samples pushed while draining are left for the next
+    call, which keeps a fast producer from stalling the GUI.  A
+    SeriesData is asked to take in the changes of other threads
+    instead, see SeriesData::update.  The queue is not drained while
+    the curve shows a SeriesData, appending would copy the series
+    and detach the curve from it, its samples stay queued until the
+    curve gets data of its own.
+
+    \return number of samples appended
+    \sa Curve::queue, Curve::append
+    */
+  int Curve::drain()
+  {
+    if (series_)
+    {
+      series_->update();
+      return 0;
+    }
+    if (!queue_)
+      return 0;
+
+    int left = queue_->size(), total = 0;
+    const double *x, *y;
+    for (int k; left > 0 && (k = queue_->span(x, y)) > 0; left -= k)
+    {
+      k = std::min(k, left);
+      append(x, y, k);
+      queue_->consume(k);
+      total += k;
+    }
+    return total;
+  }
+
+  /*!
+    \brief Drop the oldest samples of unwrapped data exceeding the capacity
+    \return true if samples were dropped
+    */
+  bool Curve::fit_capacity_()
+  {
+    if (capacity_ <= 0 || series_)
+      return false;
+    if (sharedX_ && xSize_ > capacity_)
+      own_();
+
+    bool changed = false;
+    if (uniform_ && ySize_ > capacity_)
+    {
+      xShift_ += ySize_ - capacity_;
+      changed = true;
+    }
+    else if (xSize_ > capacity_)
+    {
+      if (!borrowed_)
+      {
+        std::vector<double> &xv = x_.write();
+        xv.erase(xv.begin(), xv.end() - capacity_);
+      }
+      xp_ += xSize_ - capacity_;
+      changed = true;
+    }
+    if (ySize_ > capacity_)
+    {
+      if (!borrowed_)
+      {
+        std::vector<double> &yv = y_.write();
+        yv.erase(yv.begin(), yv.end() - capacity_);
+      }
+      yp_ += ySize_ - capacity_;
+      changed = true;
+    }
+
+    if (borrowed_)
+    {
+      xSize_ = std::min(xSize_, capacity_);
+      ySize_ = std::min(ySize_, capacity_);
+    }
+    else
+      sync_();
+    return changed;
+  }
+
+  //! Point the sample pointers to the curve's own arrays
+  void Curve::sync_()
+  {
+    xp_ = sharedX_ ? sharedX_->data() : x_.data();
+    yp_ = y_.data();
+    ySize_ = y_.size();
+    if (uniform_)
+      xSize_ = ySize_;
+    else
+      xSize_ = sharedX_ ? sharedX_->size() : x_.size();
+  }
+
+  //! Copy referenced samples into the curve's own arrays
+  void Curve::own_()
+  {
+    if (series_)
+    {
+      const int size = series_->size();
+      std::vector<double> &xv = x_.replace(), &yv = y_.replace();
+      xv.resize(size);
+      yv.resize(size);
+      series_->fetch(0, size, xv.data(), yv.data());
+      release_();
+      sync_();
+      return;
+    }
+    if (sharedX_)
+    {
+      x_.assign(xp_, xp_ + xSize_);
+      release_();
+      sync_();
+      return;
+    }
+    if (!borrowed_)
+      return;
+
+    x_.assign(xp_, xp_ + xSize_);
+    y_.assign(yp_, yp_ + ySize_);
+    release_();
+    sync_();
+  }
+
+  //! Store the x values of uniformly sampled data explicitly
+  void Curve::own_x_()
+  {
+    if (!uniform_)
+      return;
+
+    std::vector<double> &xv = x_.replace();
+    xv.resize(ySize_);
+    for (int i = 0; i < ySize_; i++)
+      xv[index_(i)] = x(i);
+    uniform_ = false;
+    sync_();
+  }
+
+  //! Read the samples from \a data and follow its changes
+  void Curve::attach_(const Glib::RefPtr<SeriesData> &data)
+  {
+    series_ = data;
+    if (series_)
+      seriesConnection_ = series_->signal_changed.connect(
+          sigc::mem_fun(*this, &Curve::data_changed));
+  }
+
+  //! Reference the x values of \a xData and follow its changes
+  void Curve::attach_x_(const Glib::RefPtr<SharedAxis> &xData)
+  {
+    sharedX_ = xData;
+    if (sharedX_)
+      sharedXConnection_ = sharedX_->signal_changed.connect(
+          sigc::mem_fun(*this, &Curve::shared_x_changed_));
+    sync_();
+  }
+
+  //! Follow a change of the shared x values
+  void Curve::shared_x_changed_()
+  {
+    sync_();
+    data_changed();
+  }
+
+  /*!
+    \brief Stop referencing external samples
+
+    Detaches from the SeriesData or the SharedAxis, or releases the
+    caller's arrays, see Curve::set_raw_data.
+    */
+  void Curve::release_()
+  {
+    if (series_)
+    {
+      seriesConnection_.disconnect();
+      series_.reset();
+    }
+    if (sharedX_)
+    {
+      sharedXConnection_.disconnect();
+      sharedX_.reset();
+    }
+    if (!borrowed_)
+      return;
+
+    borrowed_ = false;
+    sigc::slot<void> release = release_slot_;
+    release_slot_ = sigc::slot<void>();
+    if (!release.empty())
+      release();
+  }
+
+  /*!
+    \brief Drop what is derived from the \a n oldest samples, before
+    they are overwritten
+    */
+  void Curve::evict_(int n)
+  {
+    if (boundsVersion_ == version_)
+    {
+      // the bounds survive unless an extreme is evicted
+      double x1, x2, y1, y2;
+      range_bounds_(0, n, x1, x2, y1, y2);
+      if (x1 <= xMin_ || x2 >= xMax_ || y1 <= yMin_ || y2 >= yMax_)
+        boundsVersion_ = 0;
+    }
+
+    if (lodValid_)
+      lod_.evict(n);
+  }
+
+  /*!
+    \brief Give access to consecutive samples
+
+    Owned and referenced arrays are accessed in place, up to the end
+    of the ring buffer.  The x values of uniformly sampled data are
+    computed into \a xb.  Series data that does not support
+    SeriesData::span is fetched into \a xb and \a yb, which must hold
+    DrawChunk values.
+
+    \return the number of samples available through \a x and \a y,
+    at most \a n
+    */
+  int Curve::read_(int from, int n, const double *&x, const double *&y,
+      double *xb, double *yb) const
+  {
+    if (!series_)
+    {
+      const int p = index_(from);
+      n = std::min(n, xSize_ - p);
+      y = yp_ + p;
+      if (!uniform_)
+      {
+        x = xp_ + p;
+        return n;
+      }
+
+      n = std::min(n, DrawChunk);
+      for (int k = 0; k < n; k++)
+        xb[k] = Curve::x(from + k);
+      x = xb;
+      return n;
+    }
+
+    const int k = series_->span(from, n, x, y);
+    if (k > 0)
+      return std::min(k, n);
+
+    n = std::min(n, DrawChunk);
+    series_->fetch(from, n, xb, yb);
+    x = xb;
+    y = yb;
+    return n;
+  }
+
+  /*!
+    \brief Return the bounds of the samples [from, from + n)
+    \sa array_bounds
+    */
+  void Curve::range_bounds_(int from, int n, double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    xmin = ymin = HUGE_VAL;
+    xmax = ymax = -HUGE_VAL;
+    double xb[DrawChunk], yb[DrawChunk];
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const double *x, *y;
+      k = read_(i, from + n - i, x, y, xb, yb);
+
+      double x1, x2, y1, y2;
+      array_bounds(x, y, k, x1, x2, y1, y2);
+      xmin = std::min(xmin, x1);
+      xmax = std::max(xmax, x2);
+      ymin = std::min(ymin, y1);
+      ymax = std::max(ymax, y2);
+    }
+  }
+
+  /*!
+    \brief Assign a title to a curve
+    \param title new title
+    */
+  void Curve::set_title(const Glib::ustring &title)
+  {
+    title_ = title;
+    curve_changed();
+  }
+
+  /*!
+    \brief Return the title.
+    \sa Curve::set_title
+    */
+  const Glib::ustring &Curve::title() const
+  {
+    return title_;
+  }
+
+  /*!
+    Returns the bounding rectangle of the curve data. If there is
+    no bounding rect, like for empty data the rectangle is invalid:
+    Rect<double>.is_valid() == FALSE
+
+    NaN samples are ignored.  The data is scanned in a single pass,
+    see array_bounds().  The result is cached until the data changes,
+    and Curve::append only merges the bounds of the new samples.
+    */
+
+  Rect<double> Curve::bounding_rect() const
+  {
+    if ( (data_size() == 0) || (xSize_ != ySize_) )
+      return Rect<double>(1.0, -1.0, 1.0, -1.0); // invalid
+
+    if (boundsVersion_ != version_)
+    {
+      const MinMaxIndex *idx = lod();
+      if (idx)
+      {
+        // the first index node may still cover evicted samples,
+        // which are looked up in the data instead
+        const int size = data_size();
+        const int bs = idx->block_size(0);
+        const int head = std::min(size, (bs - idx->first() % bs) % bs);
+        range_bounds_(0, head, xMin_, xMax_, yMin_, yMax_);
+        if (head < size)
+        {
+          const MinMaxIndex::Node r =
+            idx->range(idx->first() + head, idx->first() + size - 1);
+          xMin_ = std::min(xMin_, r.xmin);
+          xMax_ = std::max(xMax_, r.xmax);
+          yMin_ = std::min(yMin_, r.ymin);
+          yMax_ = std::max(yMax_, r.ymax);
+        }
+      }
+      else if (series_)
+      {
+        if (!series_->bounds(xMin_, xMax_, yMin_, yMax_))
+        {
+          xMin_ = 1.0;
+          xMax_ = -1.0;
+        }
+      }
+      else if (uniform_)
+      {
+        // the x range follows from the first and the last sample
+        sort_values(x(0), x(ySize_ - 1), xMin_, xMax_);
+        if (!array_min_max(yp_, ySize_, yMin_, yMax_))
+        {
+          yMin_ = 1.0;
+          yMax_ = -1.0;
+        }
+      }
+      else
+        array_bounds(xp_, yp_, xSize_,
+            xMin_, xMax_, yMin_, yMax_);
+      boundsVersion_ = version_;
+    }
+    //std::cerr << "MinX = " << xMin_ << " MaxX = " << xMax_
+    //          << " MinY = " << yMin_ << " MaxY = " << yMax_ << std::endl;
+
+    if (xMin_ > xMax_ || yMin_ > yMax_)
+      return Rect<double>(1.0, -1.0, 1.0, -1.0); // invalid
+
+    return Rect<double>(xMin_, xMax_, yMin_, yMax_);
+  }
+
+  /*!
+    \brief Enable or disable the level of detail index
+
+    When enabled, the curve keeps a MinMaxIndex over its data.  It is
+    built on first use and dropped whenever the data is replaced.
+    Line decimation and bounding_rect() read from the index instead
+    of scanning the samples, which keeps zooming and autoscaling
+    interactive on very long series at the cost of about two bytes
+    per sample.
+
+    \param b true to enable the index
+    \sa Curve::lod, MinMaxIndex
+    */
+  void Curve::set_lod_enabled(bool b)
+  {
+    lodEnabled_ = b;
+    if (!b)
+    {
+      lod_.clear();
+      lodValid_ = false;
+    }
+  }
+
+  /*!
+    \brief Return if the level of detail index is enabled
+    \sa Curve::set_lod_enabled
+    */
+  bool Curve::lod_enabled() const
+  {
+    return lodEnabled_;
+  }
+
+  /*!
+    \brief Return the level of detail index, building it if necessary
+    \return the index or 0 if it is disabled or the data is invalid
+    \sa Curve::set_lod_enabled
+    */
+  const MinMaxIndex *Curve::lod() const
+  {
+    if (series_ && series_->lod())
+      return series_->lod();
+    if (!lodEnabled_ || xSize_ != ySize_)
+      return 0;
+
+    if (!lodValid_)
+    {
+      double xb[DrawChunk], yb[DrawChunk];
+      const int size = data_size();
+      lod_.clear();
+      for (int i = 0, k; i < size; i += k)
+      {
+        const double *x, *y;
+        k = read_(i, size - i, x, y, xb, yb);
+        lod_.append(x, y, k);
+      }
+      lodValid_ = true;
+    }
+    return &lod_;
+  }
+
+  /*!
+    \brief Checks if a range of indices is valid and corrects it if necessary
+    \param i1 Index 1
+    \param i2 Index 2
+    */
+  int Curve::verify_range(int &i1, int &i2)
+  {
+    int size = data_size();
+
+    if (size < 1)
+      return 0;
+
+    i1 = value_limits(i1, 0, size - 1);
+    i2 = value_limits(i2, 0, size - 1);
+    sort_values(i1, i2, i1, i2);
+
+    return (i2 - i1 + 1);
+  }
+
+  /*!
+    \brief Map an interval of samples into pixel coordinates
+    \param xMap x map
+    \param yMap y map
+    \param from index of the first sample
+    \param n number of samples
+    \param xi receives the n x coordinates
+    \param yi receives the n y coordinates
+    \sa DoubleIntMap::transform(const double *, int *, int) const
+    */
+  void Curve::transform(const DoubleIntMap &xMap, const DoubleIntMap &yMap,
+      int from, int n, int *xi, int *yi) const
+  {
+    if (series_)
+    {
+      if (series_->transform(xMap, yMap, from, n, xi, yi))
+        return;
+
+      double xb[DrawChunk], yb[DrawChunk];
+      for (int i = from, k; i < from + n; i += k)
+      {
+        const double *x, *y;
+        k = read_(i, from + n - i, x, y, xb, yb);
+        xMap.transform(x, xi + i - from, k);
+        yMap.transform(y, yi + i - from, k);
+      }
+      return;
+    }
+
+    const bool logX = logCacheEnabled_ && xMap.logarithmic() && !uniform_
+      && !sharedX_;
+    const bool logY = logCacheEnabled_ && yMap.logarithmic();
+    if (logX && !logXValid_)
+    {
+      logX_.resize(xSize_);
+      log_array(xp_, logX_.data(), xSize_);
+      logXValid_ = true;
+    }
+    if (logY && !logYValid_)
+    {
+      logY_.resize(ySize_);
+      log_array(yp_, logY_.data(), ySize_);
+      logYValid_ = true;
+    }
+
+    // the x pixels of uniform data follow from the index
+    if (uniform_)
+      xMap.uniform_transform(x(from), xStep_, xi, n);
+
+    // wrapped ring buffers are transformed in two pieces
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const int p = index_(i);
+      k = std::min(from + n - i, xSize_ - p);
+
+      if (sharedX_)
+      {
+        // mapped once for all curves sharing the axis
+        const int *px = sharedX_->pixels(xMap, p, k);
+        std::copy(px, px + k, xi + i - from);
+      }
+      else if (logX)
+        xMap.log_transform(logX_.data() + p, xi + i - from, k);
+      else if (!uniform_)
+        xMap.transform(xp_ + p, xi + i - from, k);
 
-    x_ = xData;
-    y_ = yData;
-    curve_changed();
+      if (logY)
+        yMap.log_transform(logY_.data() + p, yi + i - from, k);
+      else
+        yMap.transform(yp_ + p, yi + i - from, k);
+    }
   }
 
   /*!
-    Initialize data with an array of points (explicitly shared).
+    \brief Enable or disable caching of logarithmic data
 
-    \param data Data
+    When enabled, the curve keeps log(x) and log(y) copies of its data
+    for axes with a logarithmic map.  They are computed on the first
+    draw after a change of the data, so redrawing on logarithmic axes
+    costs the same as on linear ones.  Each cached axis needs as much
+    memory as the data of that axis.
 
-    @todo test if this method really works
+    \param b true to enable the cache
+    \sa DoubleIntMap::log_transform
     */
-  void Curve::set_data(const Glib::ArrayHandle<Point<double>> &data)
+  void Curve::set_log_cache_enabled(bool b)
   {
-    x_.clear();
-    y_.clear();
-    Glib::ArrayHandle<Point<double>>::const_iterator daPnt(data.begin());
-    for (daPnt = data.begin(); daPnt != data.end(); ++daPnt) {
-      x_.push_back((*daPnt).get_x());
-      y_.push_back((*daPnt).get_y());
+    logCacheEnabled_ = b;
+    if (!b)
+    {
+      std::vector<double>().swap(logX_);
+      std::vector<double>().swap(logY_);
+      logXValid_ = logYValid_ = false;
     }
-    curve_changed();
   }
 
   /*!
-    \brief Assign a title to a curve
-    \param title new title
+    \brief Return if logarithmic data is cached
+    \sa Curve::set_log_cache_enabled
     */
-  void Curve::set_title(const Glib::ustring &title)
+  bool Curve::log_cache_enabled() const
   {
-    title_ = title;
-    curve_changed();
+    return logCacheEnabled_;
   }
 
   /*!
-    \brief Return the title.
-    \sa Curve::set_title
+    \brief Check if the x values are strictly monotonic
+
+    The result is computed once after each change of the data.
+    \return 1 for increasing, -1 for decreasing and 0 otherwise
+    \sa check_mono
     */
-  const Glib::ustring &Curve::title() const
+  int Curve::monotonic_x_() const
   {
-    return title_;
+    if (!monoValid_)
+    {
+      if (uniform_)
+        mono_ = data_size() > 1 ? SIGN(xStep_) : 0;
+      else if (lod())
+        mono_ = lod()->monotonic();
+      else if (series_)
+        mono_ = series_->monotonic();
+      else if (xSize_ != ySize_)
+        mono_ = 0;
+      else if (head_ == 0)
+        mono_ = check_mono(xp_, xSize_);
+      else
+      {
+        mono_ = SIGN(x(1) - x(0));
+        for (int i = 2; mono_ != 0 && i < data_size(); i++)
+        {
+          if (SIGN(x(i) - x(i - 1)) != mono_)
+            mono_ = 0;
+        }
+      }
+      monoValid_ = true;
+    }
+    return mono_;
   }
 
-  /*!
-    Returns the bounding rectangle of the curve data. If there is
-    no bounding rect, like for empty data the rectangle is invalid:
-    Rect<double>.is_valid() == FALSE
-    */
+  namespace {
 
-  Rect<double> Curve::bounding_rect() const
-  {
-    if ( (x_.size() == 0) || (x_.size() != y_.size()) )
-      return Rect<double>(1.0, -1.0, 1.0, -1.0); // invalid
+    /* Return the first index in [a, b) whose x value is not before v,
+       in the direction given by mono, like std::lower_bound */
+    int lower_x(const Curve &c, int a, int b, double v, int mono)
+    {
+      while (a < b)
+      {
+        const int m = a + (b - a) / 2;
+        if (mono > 0 ? c.x(m) < v : c.x(m) > v)
+          a = m + 1;
+        else
+          b = m;
+      }
+      return a;
+    }
+
+    /* Return the first index in [a, b) whose x value is after v,
+       in the direction given by mono, like std::upper_bound */
+    int upper_x(const Curve &c, int a, int b, double v, int mono)
+    {
+      while (a < b)
+      {
+        const int m = a + (b - a) / 2;
+        if (mono > 0 ? v < c.x(m) : v > c.x(m))
+          b = m;
+        else
+          a = m + 1;
+      }
+      return a;
+    }
+
+    /* Narrow [a, b) to the samples of the level 0 index node that
+       holds the result of lower_x (upper == false) or upper_x (upper
+       == true), so the search reads the samples of one node only */
+    void narrow_x(const MinMaxIndex &idx, int &a, int &b, double v,
+        int mono, bool upper)
+    {
+      if (a >= b)
+        return;
+
+      const int base = idx.first();
+      const int bs = idx.block_size(0);
+      const int jb = std::min((base + b - 1) / bs + 1, idx.end_node(0));
+      int ja = (base + a) / bs, je = jb;
+      while (ja < je)
+      {
+        const int m = ja + (je - ja) / 2;
+        const MinMaxIndex::Node &nd = idx.node(0, m);
+        const bool before = upper ? (mono > 0 ? !(v < nd.xmax) : !(v > nd.xmin))
+                                  : (mono > 0 ? nd.xmax < v : nd.xmin > v);
+        if (before)
+          ja = m + 1;
+        else
+          je = m;
+      }
 
-    //NOTE: The following four lines replicate the above algorithm
-    //      However, as this makes four loops instead of one, it will
-    //      be a little slower!
+      if (ja == jb)
+        a = b;
+      else
+      {
+        a = std::max(a, ja * bs - base);
+        b = std::min(b, (ja + 1) * bs - base);
+      }
+    }
 
-    double minX = *std::min_element(x_.begin(), x_.end());
-    double maxX = *std::max_element(x_.begin(), x_.end());
-    double minY = *std::min_element(y_.begin(), y_.end());
-    double maxY = *std::max_element(y_.begin(), y_.end());
-    //std::cerr << "MinX = " << minX << " MaxX = " << maxX
-    //          << " MinY = " << minY << " MaxY = " << maxY << std::endl;
+    /* Like lower_x (upper == false) or upper_x (upper == true) for
+       uniformly sampled x: the index is computed from x0 and dx, then
+       corrected by the rounding error of the x values */
+    int uniform_bound(const Curve &c, int a, int b, double v, int mono,
+        bool upper, double x0, double dx)
+    {
+      const double e = upper ? floor((v - x0) / dx) + 1 : ceil((v - x0) / dx);
+      int i = a;
+      if (e > b)
+        i = b;
+      else if (e > a)
+        i = static_cast<int>(e);
+
+      // samples before the result satisfy "before", the others do not
+      while (i > a)
+      {
+        const double xv = c.x(i - 1);
+        const bool before = upper ? (mono > 0 ? !(v < xv) : !(v > xv))
+                                  : (mono > 0 ? xv < v : xv > v);
+        if (before)
+          break;
+        i--;
+      }
+      while (i < b)
+      {
+        const double xv = c.x(i);
+        const bool before = upper ? (mono > 0 ? !(v < xv) : !(v > xv))
+                                  : (mono > 0 ? xv < v : xv > v);
+        if (!before)
+          break;
+        i++;
+      }
+      return i;
+    }
 
-    return Rect<double>(minX, maxX, minY, maxY);
   }
 
   /*!
-    \brief Checks if a range of indices is valid and corrects it if necessary
-    \param i1 Index 1
-    \param i2 Index 2
+    \brief Narrow an index range to the samples visible through a map
+
+    For monotonic x the first and last visible sample are found by
+    binary search, for uniformly sampled x they are computed.  One sample on either side is kept, so that lines
+    still enter and leave the viewport.  Other curves are left alone.
+
+    \param xMap x map
+    \param from index of the first point, updated
+    \param to index of the last point, updated
     */
-  int Curve::verify_range(int &i1, int &i2)
+  void Curve::visible_range_(const DoubleIntMap &xMap, int &from, int &to) const
   {
-    int size = data_size();
+    const int mono = monotonic_x_();
+    if (mono == 0 || to <= from)
+      return;
 
-    if (size < 1)
-      return 0;
+    double lo, hi;
+    sort_values(xMap.inv_transform(xMap.i1()), xMap.inv_transform(xMap.i2()),
+        lo, hi);
 
-    i1 = value_limits(i1, 0, size - 1);
-    i2 = value_limits(i2, 0, size - 1);
-    sort_values(i1, i2, i1, i2);
+    int first, last;
+    double x0, dx;
+    if (uniform_x(x0, dx))
+    {
+      // constant time, x(i) = x0 + i * dx
+      first = uniform_bound(*this, from, to + 1, mono > 0 ? lo : hi, mono,
+          false, x0, dx) - 1;
+      last = uniform_bound(*this, from, to + 1, mono > 0 ? hi : lo, mono,
+          true, x0, dx);
+    }
+    else
+    {
+      const double v1 = mono > 0 ? lo : hi, v2 = mono > 0 ? hi : lo;
+      int a1 = from, b1 = to + 1, a2 = from, b2 = to + 1;
 
-    return (i2 - i1 + 1);
+      // the index nodes locate the samples to search, which keeps
+      // paged data from loading all pages on the way
+      const MinMaxIndex *idx = lod();
+      if (idx && idx->monotonic() == mono && idx->size() == data_size())
+      {
+        narrow_x(*idx, a1, b1, v1, mono, false);
+        narrow_x(*idx, a2, b2, v2, mono, true);
+      }
+
+      first = lower_x(*this, a1, b1, v1, mono) - 1;
+      last = upper_x(*this, a2, b2, v2, mono);
+    }
+
+    from = std::max(from, first);
+    to = std::min(to, last);
   }
 
   /*!
@@ -272,6 +1530,9 @@ namespace PlotMM {
     \param to index of the last point to be painted. If to < 0 the
     curve will be painted to its last point.
 
+    For monotonic x, samples outside the x range of \a xMap are
+    skipped, see Curve::visible_range_.
+
     \sa Curve::draw_curve_, Curve::draw_dots_,
     Curve::draw_lines_, Curve::draw_symbols_,
     Curve::draw_lsteps_, Curve::draw_csteps_,
@@ -280,6 +1541,15 @@ namespace PlotMM {
   void Curve::draw(const Cairo::RefPtr<Cairo::Context> &cr, const Glib::RefPtr<Gdk::Window> painter,
       const DoubleIntMap &xMap, const DoubleIntMap &yMap, int from, int to)
   {
+    // sources with several resolutions serve the one of the map
+    if (series_ && xMap.i1() != xMap.i2())
+    {
+      const double dx = fabs(xMap.inv_transform(xMap.i2())
+          - xMap.inv_transform(xMap.i1())) / abs(xMap.i2() - xMap.i1());
+      if (series_->set_resolution(dx))
+        invalidate_();
+    }
+
     if ( data_size() <= 0 )
       return;
 
@@ -289,6 +1559,7 @@ namespace PlotMM {
     if (to < 0)
       to = data_size() - 1;
     if ( verify_range(from, to) > 0 ) {
+      visible_range_(xMap, from, to);
       draw_curve_(cr, painter, cStyle_, xMap, yMap, from, to);
 
       if (symbol_->style() != SYMBOL_NONE) {
@@ -351,51 +1622,218 @@ namespace PlotMM {
   void Curve::draw_lines_(const Cairo::RefPtr<Cairo::Context> &cr, const Glib::RefPtr<Gdk::Window> painter,
       const DoubleIntMap &xMap, const DoubleIntMap &yMap, int from, int to)
   {
-    int xi, yi;
+    std::vector<Gdk::Point> polyline;
+    decimate_lines_(xMap, yMap, from, to, polyline);
+    if (polyline.empty())
+      return;
 
     paint()->set_cr_to_pen(cr);
     cr->set_line_width(1.0);
 
-    xi = xMap.transform(x(from));
-    yi = xMap.transform(y(from));
+    cr->move_to(polyline[0].get_x(), polyline[0].get_y());
+    for (unsigned int i = 1; i < polyline.size(); i++)
+      cr->line_to(polyline[i].get_x(), polyline[i].get_y());
 
-    cr->move_to(xMap.transform(x(from)), yMap.transform(y(from)));
-    for (int i = from; i <= to; i++)
-    {
+    cr->stroke();
 
-      // transform converts a double to int or a log conversion to int.
-      xi = xMap.transform(x(i));
-      yi = yMap.transform(y(i));
-      cr->line_to(xi, yi);
+    //  Not sure why you would ever want the following
+    if ( paint()->filled() )
+    {
+      paint()->set_cr_to_brush(cr);
+      cr->move_to(polyline[0].get_x(), polyline[0].get_y());
+      for (unsigned int i = 1; i < polyline.size(); i++)
+        cr->line_to(polyline[i].get_x(), polyline[i].get_y());
 
+      // what is desired here is to fill everything below the curve so...
+      cr->line_to(polyline.back().get_x(), yMap.transform(y(0)));
+      cr->line_to(polyline.front().get_x(), yMap.transform(y(0)));
+      cr->close_path();
+      cr->fill();
     }
+  }
 
-    cr->stroke();
+  namespace {
 
-    //painter->draw_lines(paint()->pen(painter), polyline);
+    /* Collects consecutive spans that fall into the same pixel column
+       and writes the first, min, max and last vertex of each finished
+       column to a polyline. */
+    class M4Columns
+    {
+      public:
+        M4Columns(std::vector<Gdk::Point> &out, bool byRow)
+          : out_(out), byRow_(byRow), open_(false) {}
 
+        void add(int c, int v, int i)
+        {
+          add(c, v, i, v, i, v, i, v, i);
+        }
 
-    //  Not sure why you would ever want the following
-    if ( paint()->filled() )
+        void add(int c, int vf, int iff, int vn, int in,
+            int vx, int ix, int vl, int il)
+        {
+          if (open_ && c == column_)
+          {
+            if (vn < vmin_) { vmin_ = vn; iMin_ = in; }
+            if (vx > vmax_) { vmax_ = vx; iMax_ = ix; }
+            last_ = vl; iLast_ = il;
+            return;
+          }
+          flush();
+          open_ = true;
+          column_ = c;
+          first_ = vf; iFirst_ = iff;
+          vmin_ = vn; iMin_ = in;
+          vmax_ = vx; iMax_ = ix;
+          last_ = vl; iLast_ = il;
+        }
 
-    {
-      paint()->set_cr_to_brush(cr);
-      cr->move_to(xMap.transform(x(from)),yMap.transform(y(from)));
+        void flush()
+        {
+          if (!open_)
+            return;
+          const bool minFirst = iMin_ < iMax_;
+          const int idx[4] = { iFirst_, minFirst ? iMin_ : iMax_,
+                               minFirst ? iMax_ : iMin_, iLast_ };
+          const int val[4] = { first_, minFirst ? vmin_ : vmax_,
+                               minFirst ? vmax_ : vmin_, last_ };
+          for (int k = 0; k < 4; k++)
+          {
+            if (k > 0 && idx[k] == idx[k - 1])
+              continue;
+            out_.push_back(byRow_ ? Gdk::Point(val[k], column_)
+                                  : Gdk::Point(column_, val[k]));
+          }
+          open_ = false;
+        }
 
-      for (int i = from + 1; i <= to; i++)
+      private:
+        std::vector<Gdk::Point> &out_;
+        bool byRow_;
+        bool open_;
+        int column_;
+        int first_, last_, vmin_, vmax_;
+        int iFirst_, iLast_, iMin_, iMax_;
+    };
+
+    /* Add the samples i0 ... i1 to the columns */
+    void add_samples(M4Columns &columns, const Curve &c,
+        const DoubleIntMap &xMap, const DoubleIntMap &yMap,
+        int i0, int i1, bool byRow)
+    {
+      int xi[DrawChunk], yi[DrawChunk];
+      for (int i = i0; i <= i1; i += DrawChunk)
       {
-        // transform converts a double to int or a log conversion to int.
-        int xi = xMap.transform(x(i));
-        int yi = yMap.transform(y(i));
+        const int n = std::min(DrawChunk, i1 - i + 1);
+        c.transform(xMap, yMap, i, n, xi, yi);
+        for (int k = 0; k < n; k++)
+        {
+          if (byRow)
+            columns.add(yi[k], xi[k], i + k);
+          else
+            columns.add(xi[k], yi[k], i + k);
+        }
+      }
+    }
 
-        cr->line_to(xi, yi);
+    /* Add node j of an index level to the columns.  Nodes whose
+       samples spread over more than one pixel column are split into
+       their children, level 0 nodes into single samples, so the
+       result equals the reduction of the raw samples. */
+    void add_lod_node(M4Columns &columns, const Curve &c,
+        const MinMaxIndex &idx, const DoubleIntMap &xMap,
+        const DoubleIntMap &yMap, int level, int j)
+    {
+      const MinMaxIndex::Node &nd = idx.node(level, j);
+      if (nd.imin < 0)
+        return;
+
+      // index nodes count samples from the first one ever indexed
+      const int base = idx.first();
+      const int bs = idx.block_size(level);
+      const int i0 = j * bs - base;
+      const int i1 = std::min(i0 + bs, idx.size()) - 1;
+      const int c0 = xMap.transform(nd.xmin);
+      if (c0 == xMap.transform(nd.xmax))
+      {
+        const int p1 = yMap.transform(nd.ymin), p2 = yMap.transform(nd.ymax);
+        const bool lo = p1 < p2;
+        columns.add(c0, yMap.transform(nd.yfirst), i0,
+            lo ? p1 : p2, (lo ? nd.imin : nd.imax) - base,
+            lo ? p2 : p1, (lo ? nd.imax : nd.imin) - base,
+            yMap.transform(nd.ylast), i1);
       }
-      // what is desired here is to fill everything below the curve so...
-      cr->line_to(xMap.transform(x(to)), yMap.transform(y(0)));
-      cr->line_to(xMap.transform(y(from)), yMap.transform(y(0)));
-      cr->close_path();
-      cr->fill();
+      else if (level > 0)
+      {
+        add_lod_node(columns, c, idx, xMap, yMap, level - 1, 2 * j);
+        if (2 * j + 1 < idx.end_node(level - 1))
+          add_lod_node(columns, c, idx, xMap, yMap, level - 1, 2 * j + 1);
+      }
+      else
+        add_samples(columns, c, xMap, yMap, i0, i1, false);
+    }
+
+  }
+
+  /*!
+    \brief Map a curve interval to pixels, keeping at most four
+    vertices per pixel column (M4 decimation)
+
+    Consecutive samples falling into the same pixel column are
+    reduced to the first, the last, the minimum and the maximum
+    sample of that column, in index order.  A polyline drawn through
+    the result rasterizes like one drawn through all samples, but has
+    at most about 4 * width vertices no matter how many samples there
+    are.  With CURVE_X_FY the curve is reduced per pixel row instead.
+
+    If the level of detail index is enabled, x is monotonic and many
+    samples share a pixel column, whole index nodes are reduced
+    instead of single samples.  Only nodes that straddle a column
+    border are resolved further, so the result is the same.
+
+    \param xMap x map
+    \param yMap y map
+    \param from index of the first point
+    \param to index of the last point
+    \param polyline receives the reduced polyline
+    \sa Curve::draw_lines_, Curve::set_lod_enabled
+    */
+  void Curve::decimate_lines_(const DoubleIntMap &xMap,
+      const DoubleIntMap &yMap, int from, int to,
+      std::vector<Gdk::Point> &polyline) const
+  {
+    polyline.clear();
+    if (to < from)
+      return;
+
+    const bool byRow = options_ & CURVE_X_FY;
+    M4Columns columns(polyline, byRow);
+
+    // use the coarsest nodes that still cover about a quarter column
+    const MinMaxIndex *idx = byRow ? 0 : lod();
+    int level = -1;
+    if (idx && idx->monotonic())
+    {
+      const int width = abs(xMap.transform(x(to)) - xMap.transform(x(from))) + 1;
+      level = idx->level_for((to - from + 1) / (4 * width));
+    }
+
+    int i = from;
+    if (level >= 0)
+    {
+      const int base = idx->first();
+      const int bs = idx->block_size(level);
+      const int jEnd = (base + to + 1) / bs;
+
+      const int head = std::min(to, (base + from + bs - 1) / bs * bs - 1 - base);
+      add_samples(columns, *this, xMap, yMap, i, head, false);
+      i = head + 1;
+
+      for (int j = (base + i) / bs; j < jEnd; j++, i += bs)
+        add_lod_node(columns, *this, *idx, xMap, yMap, level, j);
     }
+
+    add_samples(columns, *this, xMap, yMap, i, to, byRow);
+    columns.flush();
   }
 
   /*!
@@ -416,24 +1854,26 @@ namespace PlotMM {
     int x0 = xMap.transform(baseline_);
     int y0 = yMap.transform(baseline_);
 
-    for (int i = from; i <= to; i++)
+    int xi[DrawChunk], yi[DrawChunk];
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      int xi = xMap.transform(x(i));
-      int yi = yMap.transform(y(i));
-
-      if (options_ & CURVE_X_FY)
-      {
-        cr->move_to(x0, yi);
-        cr->line_to(xi, yi);
-        cr->stroke();
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
 
-      }
-      else
+      for (int k = 0; k < n; k++)
       {
-        cr->move_to(xi, y0);
-        cr->line_to(xi, yi);
-        cr->stroke();
-
+        if (options_ & CURVE_X_FY)
+        {
+          cr->move_to(x0, yi[k]);
+          cr->line_to(xi[k], yi[k]);
+          cr->stroke();
+        }
+        else
+        {
+          cr->move_to(xi[k], y0);
+          cr->line_to(xi[k], yi[k]);
+          cr->stroke();
+        }
       }
     }
   }
@@ -453,13 +1893,18 @@ namespace PlotMM {
     paint()->set_cr_to_pen(cr);
     cr->set_line_width(8);
     cr->set_line_cap(Cairo::LINE_CAP_ROUND);
-    for (int i = from; i <= to; i++)
+
+    int xi[DrawChunk], yi[DrawChunk];
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      int xi = xMap.transform(x(i));
-      int yi = yMap.transform(y(i));
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
 
-      cr->move_to(xi, yi);
-      cr->line_to(xi, yi);
+      for (int k = 0; k < n; k++)
+      {
+        cr->move_to(xi[k], yi[k]);
+        cr->line_to(xi[k], yi[k]);
+      }
     }
 
     cr->stroke();
@@ -477,39 +1922,34 @@ namespace PlotMM {
   void Curve::draw_lsteps_(const Cairo::RefPtr<Cairo::Context> &cr, const Glib::RefPtr<Gdk::Window> painter,
       const DoubleIntMap &xMap, const DoubleIntMap &yMap, int from, int to)
   {
-    std::vector<Gdk::Point> polyline;
-
     cr->set_line_width(1.0);
     paint()->set_cr_to_pen(cr);
     bool inverted = options_ & CURVE_X_FY;
     if ( options_ & CURVE_INVERTED )
       inverted = !inverted;
 
-    int i, ip;
-    int xi = xMap.transform(x(from));
-    int yi = yMap.transform(y(from));
-
-    polyline.push_back(Gdk::Point(xi, yi));
-    cr->move_to(xMap.transform(x(from)),yMap.transform(y(from)));
-
-    for (i = from + 1, ip = 1; i <= to; i++, ip += 2)
+    int xi[DrawChunk], yi[DrawChunk];
+    int xp = 0, yp = 0;
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      xi = xMap.transform(x(i));
-      yi = yMap.transform(y(i));
-      if (inverted)
-      {
-        polyline.push_back(Gdk::Point(xi, polyline[ip - 1].get_y()));
-        cr->line_to(xi, polyline[ip - 1].get_y());
-      }
-      else
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
+
+      for (int k = 0; k < n; k++)
       {
-        polyline.push_back(Gdk::Point(polyline[ip - 1].get_x(), yi));
-        cr->line_to(polyline[ip - 1].get_x(), yi);
+        if (i + k == from)
+          cr->move_to(xi[k], yi[k]);
+        else
+        {
+          if (inverted)
+            cr->line_to(xi[k], yp);
+          else
+            cr->line_to(xp, yi[k]);
+          cr->line_to(xi[k], yi[k]);
+        }
+        xp = xi[k];
+        yp = yi[k];
       }
-
-      polyline.push_back(Gdk::Point(xi, yi));
-      cr->line_to(xi, yi);
-
     }
 
     cr->stroke();
@@ -537,8 +1977,6 @@ namespace PlotMM {
   void Curve::draw_csteps_(const Cairo::RefPtr<Cairo::Context> &cr, const Glib::RefPtr<Gdk::Window> painter,
       const DoubleIntMap &xMap, const DoubleIntMap &yMap, int from, int to)
   {
-    std::vector<Gdk::Point> polyline;
-
     paint()->set_cr_to_pen(cr);
 
     cr->set_line_width(1.0);
@@ -547,38 +1985,55 @@ namespace PlotMM {
     if ( options_ & CURVE_INVERTED )
       inverted = !inverted;
 
-    int i, ip;
-
-    int xi = xMap.transform(x(from));
-    int yi = yMap.transform(y(from));
-    polyline.push_back(Gdk::Point(xi, yi));
-    cr->move_to(xMap.transform(x(from)), yMap.transform(y(from)));
-
-    for (i = from + 1, ip = 0; i <= to; i++, ip += 2)
+    int xi[DrawChunk], yi[DrawChunk], mi[DrawChunk];
+    double xv[DrawChunk + 1], yv[DrawChunk + 1], mid[DrawChunk];
+    int xp = 0, yp = 0;
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      int xn,yn;
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
+
+      // the steps are centered between neighbouring samples, so the
+      // sample before the chunk is read as well
+      const int j0 = std::max(i - 1, from);
+      const int o = i - j0;
+      fetch(j0, n + o, xv, yv);
+      const double *v = inverted ? yv : xv;
+      for (int k = 0; k < n; k++)
+        mid[k] = (v[k + o] + v[std::max(k + o - 1, 0)]) * 0.5;
       if (inverted)
-      {
-        xn = xMap.transform(x(i));
-        yn = yMap.transform((y(i) + y(i - 1)) * 0.5);
-        polyline.push_back(Gdk::Point(xi, yn));
-        cr->line_to(xi, yn);
-      }
+        yMap.transform(mid, mi, n);
       else
+        xMap.transform(mid, mi, n);
+
+      for (int k = 0; k < n; k++)
       {
-        xn = xMap.transform((x(i) + x(i - 1)) * 0.5);
-        yn = yMap.transform(y(i));
-        polyline.push_back(Gdk::Point(xn, yi));
-        cr->line_to(xn, yi);
+        if (i + k == from)
+        {
+          cr->move_to(xi[k], yi[k]);
+          xp = xi[k];
+          yp = yi[k];
+          continue;
+        }
+
+        int xn, yn;
+        if (inverted)
+        {
+          xn = xi[k];
+          yn = mi[k];
+          cr->line_to(xp, yn);
+        }
+        else
+        {
+          xn = mi[k];
+          yn = yi[k];
+          cr->line_to(xn, yp);
+        }
+        xp = xn; yp = yn;
+        cr->line_to(xp, yp);
       }
-      xi = xn; yi = yn;
-      polyline.push_back(Gdk::Point(xi, yi));
-      cr->line_to(xi, yi);
-    }
-    xi = xMap.transform(x(to));
-    yi = yMap.transform(y(to));
-    polyline.push_back(Gdk::Point(xi, yi));
-    cr->line_to(xi, yi);
+    }
+    cr->line_to(xMap.transform(x(to)), yMap.transform(y(to)));
     cr->stroke();
 
     if ( paint()->filled() )
@@ -606,8 +2061,6 @@ namespace PlotMM {
   void Curve::draw_rsteps_(const Cairo::RefPtr<Cairo::Context> &cr, const Glib::RefPtr<Gdk::Window> painter,
       const DoubleIntMap &xMap, const DoubleIntMap &yMap, int from, int to)
   {
-    std::vector<Gdk::Point> polyline;
-
     paint()->set_cr_to_pen(cr);
 
     cr->set_line_width(1.0);
@@ -616,34 +2069,26 @@ namespace PlotMM {
     if ( options_ & CURVE_INVERTED )
       inverted = !inverted;
 
-    int i, ip;
-
-    int xi = xMap.transform(x(from));
-    int yi = yMap.transform(y(from));
-
-    cr->move_to(xi, yi);
-
-    for (i = from, ip = 0; i <= to; i++, ip += 2)
+    int xi[DrawChunk], yi[DrawChunk];
+    int xp = 0, yp = 0;
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      int xi = xMap.transform(x(i));
-      int yi = yMap.transform(y(i));
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
 
-      if ( ip > 0 )
+      for (int k = 0; k < n; k++)
       {
-        if (inverted)
-        {
-          polyline.push_back(Gdk::Point(polyline[ip - 2].get_x(), yi));
-          cr->line_to(polyline[ip - 2].get_x(), yi);
-        }
+        if (i + k == from)
+          cr->move_to(xi[k], yi[k]);
+        else if (inverted)
+          cr->line_to(xp, yi[k]);
         else
-        {
-          polyline.push_back(Gdk::Point(xi, polyline[ip - 2].get_y()));
-          cr->line_to(xi, polyline[ip - 2].get_y());
-        }
-      }
+          cr->line_to(xi[k], yp);
 
-      polyline.push_back(Gdk::Point(xi, yi));
-      cr->line_to(xi, yi);
+        cr->line_to(xi[k], yi[k]);
+        xp = xi[k];
+        yp = yi[k];
+      }
     }
     cr->stroke();
     {
@@ -742,12 +2187,14 @@ namespace PlotMM {
       const DoubleIntMap &yMap,
       int from, int to)
   {
-    for (int i = from; i <= to; i++)
+    int xi[DrawChunk], yi[DrawChunk];
+    for (int i = from; i <= to; i += DrawChunk)
     {
-      const int xi = xMap.transform(x(i));
-      const int yi = yMap.transform(y(i));
+      const int n = std::min(DrawChunk, to - i + 1);
+      transform(xMap, yMap, i, n, xi, yi);
 
-      symbol->draw(cr, painter, xi, yi);
+      for (int k = 0; k < n; k++)
+        symbol->draw(cr, painter, xi[k], yi[k]);
     }
   }
 
@@ -779,12 +2226,28 @@ namespace PlotMM {
     return baseline_;
   }
 
+  /*!
+    \brief Return the version of the curve's data
+
+    The version is incremented on every change of the data, including
+    appends.  It can be compared with a previously returned value to
+    find out if anything derived from the data is still up to date.
+    */
+  unsigned long Curve::data_version() const
+  {
+    return version_;
+  }
+
   /*!
     Return the size of the data arrays
+
+    If the x and y arrays differ in size, as with a SharedAxis whose
+    values grew before the y values of this curve, only the samples
+    present in both are counted.
     */
   int Curve::data_size() const
   {
-    return x_.size();
+    return series_ ? series_->size() : std::min(xSize_, ySize_);
   }
 
   /*!
@@ -798,4 +2261,87 @@ namespace PlotMM {
     signal_curve_changed();
   }
 
+  /*!
+    \brief Notify a change of the curve's data.
+    Drops everything derived from the samples and calls curve_changed().
+    Derived classes that modify the data must call this function.
+    */
+  void Curve::data_changed()
+  {
+    invalidate_();
+    curve_changed();
+  }
+
+  //! Drop everything derived from the samples
+  void Curve::invalidate_()
+  {
+    lodValid_ = false;
+    monoValid_ = false;
+    logXValid_ = logYValid_ = false;
+    version_++;
+  }
+
+  /*!
+    \brief Notify that samples were added to the end of the data
+
+    Everything derived from the data is extended by the last \a n
+    samples rather than dropped, then curve_changed() is called.
+    Derived classes that append to the data must call this function,
+    or data_changed() if they cannot keep the data of both axes in
+    step.
+
+    \param n number of new samples
+    */
+  void Curve::data_appended(int n)
+  {
+    const int from = data_size() - n;
+
+    if (boundsVersion_ == version_)
+    {
+      double x1, x2, y1, y2;
+      range_bounds_(from, n, x1, x2, y1, y2);
+      xMin_ = std::min(xMin_, x1);
+      xMax_ = std::max(xMax_, x2);
+      yMin_ = std::min(yMin_, y1);
+      yMax_ = std::max(yMax_, y2);
+      boundsVersion_ = version_ + 1;
+    }
+
+    if (monoValid_)
+    {
+      if (from < 2)
+        monoValid_ = false;
+      for (int i = from; monoValid_ && mono_ != 0 && i < from + n; i++)
+      {
+        if (SIGN(x(i) - x(i - 1)) != mono_)
+          mono_ = 0;
+      }
+    }
+
+    if (logXValid_)
+      logX_.resize(xSize_);
+    if (logYValid_)
+      logY_.resize(ySize_);
+    double xb[DrawChunk], yb[DrawChunk];
+    for (int i = from, k; lodValid_ && i < from + n; i += k)
+    {
+      const double *x, *y;
+      k = read_(i, from + n - i, x, y, xb, yb);
+      lod_.append(x, y, k);
+    }
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const int p = index_(i);
+      k = std::min(from + n - i, xSize_ - p);
+
+      if (logXValid_)
+        log_array(xp_ + p, logX_.data() + p, k);
+      if (logYValid_)
+        log_array(yp_ + p, logY_.data() + p, k);
+    }
+
+    version_++;
+    curve_changed();
+  }
+
 } //namespace PlotMM
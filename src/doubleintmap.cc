@@ -8,12 +8,199 @@
 /* ported from qwt */
 
 #include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PLOTMM_AVX2_DISPATCH 1
+#endif
 
 #include "supplemental.h"
 #include "doubleintmap.h"
 
 namespace PlotMM {
 
+  namespace {
+
+    // Samples are mapped in chunks of this size when a temporary
+    // buffer is needed (logarithmic maps).
+    const int TransformChunk = 512;
+
+    // |(x - d1) * cnv| is limited to this value before rounding, which
+    // keeps the result inside the int range for any input.
+    const double TransformLimit = 1073741824.0;
+
+    template <class T> struct LinearKernel
+    {
+      typedef void (*type)(const T *, int *, int, double, double, int);
+    };
+
+    /* Linear map with rounding like iround(), i.e. halfway cases away
+       from zero.  Reference implementation and tail handler for the
+       SIMD kernels. */
+    template <class T>
+    void linear_kernel_scalar(const T *x, int *out, int n,
+        double x1, double cnv, int y1)
+    {
+      for (int i = 0; i < n; i++)
+      {
+        const double t = value_limits((static_cast<double>(x[i]) - x1) * cnv,
+            -TransformLimit, TransformLimit);
+        out[i] = y1 + iround(t);
+      }
+    }
+
+#if defined(__SSE2__)
+    // load two samples of any supported type as doubles
+    inline __m128d load2(const double *p)
+    {
+      return _mm_loadu_pd(p);
+    }
+
+    inline __m128d load2(const float *p)
+    {
+      return _mm_cvtps_pd(_mm_castsi128_ps(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+    }
+
+    inline __m128d load2(const int32_t *p)
+    {
+      return _mm_cvtepi32_pd(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    inline __m128d load2(const int16_t *p)
+    {
+      int32_t v;
+      memcpy(&v, p, sizeof(v));
+      const __m128i w = _mm_cvtsi32_si128(v);
+      return _mm_cvtepi32_pd(_mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16));
+    }
+
+    template <class T>
+    void linear_kernel_sse2(const T *x, int *out, int n,
+        double x1, double cnv, int y1)
+    {
+      const __m128d vx1 = _mm_set1_pd(x1);
+      const __m128d vcnv = _mm_set1_pd(cnv);
+      const __m128d vlim = _mm_set1_pd(TransformLimit);
+      const __m128d half = _mm_set1_pd(0.5);
+      const __m128d sign = _mm_set1_pd(-0.0);
+      const __m128i vy1 = _mm_set1_epi32(y1);
+
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128i r[2];
+        for (int k = 0; k < 2; k++)
+        {
+          const __m128d t = _mm_mul_pd(_mm_sub_pd(load2(x + i + 2 * k), vx1), vcnv);
+          // round |t| half up, then restore the sign
+          const __m128d a = _mm_min_pd(_mm_andnot_pd(sign, t), vlim);
+          __m128i ia = _mm_cvttpd_epi32(a);
+          const __m128d frac = _mm_sub_pd(a, _mm_cvtepi32_pd(ia));
+          const __m128d up = _mm_cmpge_pd(frac, half);
+          ia = _mm_sub_epi32(ia, _mm_shuffle_epi32(_mm_castpd_si128(up), 0x08));
+          const __m128i neg = _mm_shuffle_epi32(
+              _mm_castpd_si128(_mm_cmplt_pd(t, _mm_setzero_pd())), 0x08);
+          r[k] = _mm_sub_epi32(_mm_xor_si128(ia, neg), neg);
+        }
+        const __m128i v = _mm_unpacklo_epi64(r[0], r[1]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(v, vy1));
+      }
+      linear_kernel_scalar(x + i, out + i, n - i, x1, cnv, y1);
+    }
+#endif
+
+#if defined(PLOTMM_AVX2_DISPATCH)
+    // load four samples of any supported type as doubles
+    __attribute__((target("avx2")))
+    inline __m256d load4(const double *p)
+    {
+      return _mm256_loadu_pd(p);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256d load4(const float *p)
+    {
+      return _mm256_cvtps_pd(_mm_loadu_ps(p));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256d load4(const int32_t *p)
+    {
+      return _mm256_cvtepi32_pd(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256d load4(const int16_t *p)
+    {
+      return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+    }
+
+    template <class T>
+    __attribute__((target("avx2")))
+    void linear_kernel_avx2(const T *x, int *out, int n,
+        double x1, double cnv, int y1)
+    {
+      const __m256d vx1 = _mm256_set1_pd(x1);
+      const __m256d vcnv = _mm256_set1_pd(cnv);
+      const __m256d vlim = _mm256_set1_pd(TransformLimit);
+      const __m256d half = _mm256_set1_pd(0.5);
+      const __m256d sign = _mm256_set1_pd(-0.0);
+      const __m128i vy1 = _mm_set1_epi32(y1);
+
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        const __m256d t = _mm256_mul_pd(_mm256_sub_pd(load4(x + i), vx1), vcnv);
+        const __m256d a = _mm256_min_pd(_mm256_andnot_pd(sign, t), vlim);
+        const __m256d fl = _mm256_floor_pd(a);
+        const __m256d up = _mm256_cmp_pd(_mm256_sub_pd(a, fl), half, _CMP_GE_OQ);
+        const __m256d r = _mm256_add_pd(fl, _mm256_and_pd(up, _mm256_set1_pd(1.0)));
+        // copy the sign of t back, -0.0 converts to 0
+        const __m256d sr = _mm256_or_pd(r, _mm256_and_pd(sign, t));
+        const __m128i v = _mm256_cvttpd_epi32(sr);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi32(v, vy1));
+      }
+      linear_kernel_scalar(x + i, out + i, n - i, x1, cnv, y1);
+    }
+#endif
+
+    template <class T>
+    typename LinearKernel<T>::type select_linear_kernel()
+    {
+#if defined(PLOTMM_AVX2_DISPATCH)
+      // may run before the CPU model is set up by libgcc
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+        return linear_kernel_avx2<T>;
+#endif
+#if defined(__SSE2__)
+      return linear_kernel_sse2<T>;
+#else
+      return linear_kernel_scalar<T>;
+#endif
+    }
+
+    /* Linear map of an array, with the best kernel for the sample
+       type and the CPU */
+    template <class T>
+    void linear_kernel(const T *x, int *out, int n,
+        double x1, double cnv, int y1)
+    {
+      static const typename LinearKernel<T>::type kernel =
+        select_linear_kernel<T>();
+      kernel(x, out, n, x1, cnv, y1);
+    }
+
+  }
+
   /*!
     \brief Constructor
 
@@ -173,6 +360,196 @@ namespace PlotMM {
   }
 
 
+  /*!
+    \brief Transform an array of points in the double interval into
+    the integer interval
+
+    Same as calling DoubleIntMap::transform for every element, but the
+    choice between linear and logarithmic mapping is made once and the
+    linear part runs in SSE2 or, if the CPU supports it, AVX2 kernels.
+    Results whose magnitude would exceed 2^30 are limited to it.  On
+    logarithmic maps non-positive values are mapped like LogMin.
+
+    \param x values
+    \param out receives the transformed values
+    \param n number of values
+    */
+  void DoubleIntMap::transform(const double *x, int *out, int n) const
+  {
+    if (!d_log)
+    {
+      linear_kernel(x, out, n, d_x1, d_cnv, d_y1);
+      return;
+    }
+
+    double buf[TransformChunk];
+    for (int i = 0; i < n; i += TransformChunk)
+    {
+      const int m = std::min(TransformChunk, n - i);
+      log_array(x + i, buf, m);
+      linear_kernel(buf, out + i, m, d_x1, d_cnv, d_y1);
+    }
+  }
+
+  /*!
+    \brief Transform an array of compact samples
+
+    The samples stand for the values x[i] * scale + offset.  On linear
+    maps scale and offset are folded into the map, and the samples are
+    converted to double inside the SIMD kernels, so the values are
+    never stored as doubles.
+
+    \param x samples
+    \param out receives the transformed values
+    \param n number of samples
+    \param scale scale factor of the samples
+    \param offset offset of the samples
+    \sa DoubleIntMap::transform(const double *, int *, int) const
+    */
+  void DoubleIntMap::transform(const float *x, int *out, int n,
+      double scale, double offset) const
+  {
+    transform_(x, out, n, scale, offset);
+  }
+
+  //! \copydoc DoubleIntMap::transform(const float *, int *, int, double, double) const
+  void DoubleIntMap::transform(const int16_t *x, int *out, int n,
+      double scale, double offset) const
+  {
+    transform_(x, out, n, scale, offset);
+  }
+
+  //! \copydoc DoubleIntMap::transform(const float *, int *, int, double, double) const
+  void DoubleIntMap::transform(const int32_t *x, int *out, int n,
+      double scale, double offset) const
+  {
+    transform_(x, out, n, scale, offset);
+  }
+
+  //! Common implementation of the transforms of compact samples
+  template <class T>
+  void DoubleIntMap::transform_(const T *x, int *out, int n,
+      double scale, double offset) const
+  {
+    if (!d_log && scale != 0.0)
+    {
+      // (x * scale + offset - x1) * cnv == (x - x1') * cnv'
+      linear_kernel(x, out, n, (d_x1 - offset) / scale, d_cnv * scale, d_y1);
+      return;
+    }
+
+    double buf[TransformChunk];
+    for (int i = 0; i < n; i += TransformChunk)
+    {
+      const int m = std::min(TransformChunk, n - i);
+      for (int k = 0; k < m; k++)
+        buf[k] = x[i + k] * scale + offset;
+      transform(buf, out + i, m);
+    }
+  }
+
+  /*!
+    \brief Transform evenly spaced values x0 + i * dx, i = 0..n-1
+
+    On linear maps the result is affine in i, so it is computed from
+    the index without building the values.  Logarithmic maps build
+    the values in chunks and map them like DoubleIntMap::transform.
+
+    \param x0 first value
+    \param dx distance of the values
+    \param out receives the transformed values
+    \param n number of values
+    */
+  void DoubleIntMap::uniform_transform(double x0, double dx,
+      int *out, int n) const
+  {
+    if (!d_log)
+    {
+      const double p0 = (x0 - d_x1) * d_cnv, dp = dx * d_cnv;
+      for (int i = 0; i < n; i++)
+        out[i] = d_y1 + iround(value_limits(p0 + i * dp,
+              -TransformLimit, TransformLimit));
+      return;
+    }
+
+    double buf[TransformChunk];
+    for (int i = 0; i < n; i += TransformChunk)
+    {
+      const int m = std::min(TransformChunk, n - i);
+      for (int k = 0; k < m; k++)
+        buf[k] = x0 + (i + k) * dx;
+      transform(buf, out + i, m);
+    }
+  }
+
+  /*!
+    \brief Transform an array of logarithms of points
+
+    For a logarithmic map, the result equals transform() applied to
+    exp(lx[i]), but no logarithm has to be taken.  This is used with
+    cached log(x) values, see Curve::set_log_cache_enabled.  For a
+    linear map, \a lx is mapped as is.
+
+    \param lx natural logarithms of the values
+    \param out receives the transformed values
+    \param n number of values
+    \sa log_array
+    */
+  void DoubleIntMap::log_transform(const double *lx, int *out, int n) const
+  {
+    linear_kernel(lx, out, n, d_x1, d_cnv, d_y1);
+  }
+
+  /*!
+    \brief Exact transformation of an array of points into single
+    precision pixel coordinates
+
+    \param x values
+    \param out receives the transformed values
+    \param n number of values
+    \sa DoubleIntMap::x_transform
+    */
+  void DoubleIntMap::transform(const double *x, float *out, int n) const
+  {
+    const double y1 = static_cast<double>(d_y1);
+    if (d_log)
+    {
+      for (int i = 0; i < n; i++)
+        out[i] = static_cast<float>(y1 + (log(x[i]) - d_x1) * d_cnv);
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+        out[i] = static_cast<float>(y1 + (x[i] - d_x1) * d_cnv);
+    }
+  }
+
+  /*!
+    \brief Exact transformation of an array of points
+
+    The lin/log decision is made once, the loops are left to the
+    compiler's vectorizer.
+
+    \param x values
+    \param out receives the transformed values
+    \param n number of values
+    \sa DoubleIntMap::x_transform(double)
+    */
+  void DoubleIntMap::x_transform(const double *x, double *out, int n) const
+  {
+    const double y1 = static_cast<double>(d_y1);
+    if (d_log)
+    {
+      for (int i = 0; i < n; i++)
+        out[i] = y1 + (log(x[i]) - d_x1) * d_cnv;
+    }
+    else
+    {
+      for (int i = 0; i < n; i++)
+        out[i] = y1 + (x[i] - d_x1) * d_cnv;
+    }
+  }
+
   /*!
     \brief Re-calculate the conversion factor.
     */
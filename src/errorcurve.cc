@@ -7,6 +7,7 @@
  *****************************************************************************/
 
 #include <glibmm/refptr.h>
+#include <algorithm>
 
 #include "doubleintmap.h"
 #include "errorcurve.h"
@@ -16,6 +17,13 @@
 
 namespace PlotMM {
 
+  namespace {
+
+    // Error bars are transformed in chunks of this size
+    const int ErrorChunk = 256;
+
+  }
+
   //! Initialize data members
   void ErrorCurve::init(const Glib::ustring &title)
   {
@@ -28,14 +36,23 @@ namespace PlotMM {
   {
     dx_.clear();
     dy_.clear();
+    sync_errors_();
     Curve::copy(c);
   }
 
   //! Copy the contents of a curve into another curve
   void ErrorCurve::copy(const ErrorCurve &c)
   {
-    dx_ = c.dx_;
-    dy_ = c.dy_;
+    // own error values are shared, referenced ones are copied
+    if (c.dxp_.data() == c.dx_.data())
+      dx_ = c.dx_;
+    else
+      c.dxp_.copy(dx_.replace());
+    if (c.dyp_.data() == c.dy_.data())
+      dy_ = c.dy_;
+    else
+      c.dyp_.copy(dy_.replace());
+    sync_errors_();
     epaint_ = c.epaint_;
     Curve::copy(c);
   }
@@ -64,6 +81,7 @@ namespace PlotMM {
   //! Copy Assignment
   const ErrorCurve& ErrorCurve::operator=(const ErrorCurve &c)
   {
+    // copy() replaces the data and keeps what was derived from it
     if (this != &c)
     {
       copy(c);
@@ -94,9 +112,128 @@ namespace PlotMM {
   {
     dx_.clear();
     dy_.clear();
+    sync_errors_();
+    Curve::set_data(xData, yData);
+  }
+
+  /*!
+    \brief Initialize data with x- and y-arrays by moving them into
+    the curve
+
+    \param xData x data
+    \param yData y data
+    */
+  void ErrorCurve::set_data(
+      std::vector<double> &&xData,
+      std::vector<double> &&yData)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_data(std::move(xData), std::move(yData));
+  }
+
+  /*!
+    \brief Set data by referencing the caller's memory blocks, without
+    error values
+    \sa Curve::set_raw_data
+    */
+  void ErrorCurve::set_raw_data(const double *xData, const double *yData,
+      int size, const sigc::slot<void> &release)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_raw_data(xData, yData, size, release);
+  }
+
+  /*!
+    \brief Read the samples from a SeriesData, without error values
+    \sa Curve::set_data(const Glib::RefPtr<SeriesData> &)
+    */
+  void ErrorCurve::set_data(const Glib::RefPtr<SeriesData> &data)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_data(data);
+  }
+
+  /*!
+    \brief Set data with shared x values, without error values
+    \sa Curve::set_data(const Glib::RefPtr<SharedAxis> &,
+    const std::vector<double> &)
+    */
+  void ErrorCurve::set_data(const Glib::RefPtr<SharedAxis> &xData,
+      const std::vector<double> &yData)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_data(xData, yData);
+  }
+
+  /*!
+    \brief Set data with shared x values by moving the y values into
+    the curve, without error values
+    \sa Curve::set_data(const Glib::RefPtr<SharedAxis> &,
+    std::vector<double> &&)
+    */
+  void ErrorCurve::set_data(const Glib::RefPtr<SharedAxis> &xData,
+      std::vector<double> &&yData)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_data(xData, std::move(yData));
+  }
+
+  /*!
+    \brief Set data and error values with shared x values
+
+    The x values are referenced, see Curve::set_data(const
+    Glib::RefPtr<SharedAxis> &, const std::vector<double> &).  The y
+    and error values are copied.
+    */
+  void ErrorCurve::set_data(const Glib::RefPtr<SharedAxis> &xData,
+      const std::vector<double> &yData,
+      const std::vector<double> &xErr,
+      const std::vector<double> &yErr)
+  {
+    dx_ = xErr;
+    dy_ = yErr;
+    sync_errors_();
+    drop_capacity_();
     Curve::set_data(xData, yData);
   }
 
+  /*!
+    \brief Set uniformly sampled data, without error values
+    \sa Curve::set_uniform_data
+    */
+  void ErrorCurve::set_uniform_data(double x0, double dx,
+      const double *yData, int size)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_uniform_data(x0, dx, yData, size);
+  }
+
+  /*!
+    \brief Set uniformly sampled data by moving the y values into the
+    curve, without error values
+    \sa Curve::set_uniform_data
+    */
+  void ErrorCurve::set_uniform_data(double x0, double dx,
+      std::vector<double> &&yData)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_uniform_data(x0, dx, std::move(yData));
+  }
+
   /*!
     \brief Set data by copying x- and y-values from specified memory blocks
     This function makes a 'deep copy' of the data.
@@ -112,6 +249,7 @@ namespace PlotMM {
   {
     dx_.clear();
     dy_.clear();
+    sync_errors_();
     Curve::set_data(xData, yData, size);
   }
 
@@ -127,8 +265,10 @@ namespace PlotMM {
       const double *xErr,  const double *yErr,
       int size)
   {
-    if (xErr) vector_from_c(dx_, xErr,size); else dx_.clear();
-    if (yErr) vector_from_c(dy_, yErr,size); else dy_.clear();
+    if (xErr) vector_from_c(dx_.replace(), xErr,size); else dx_.clear();
+    if (yErr) vector_from_c(dy_.replace(), yErr,size); else dy_.clear();
+    sync_errors_();
+    drop_capacity_();
     Curve::set_data(xData, yData, size);
   }
 
@@ -145,6 +285,8 @@ namespace PlotMM {
   {
     dx_= xErr;
     dy_= yErr;
+    sync_errors_();
+    drop_capacity_();
     Curve::set_data(xData, yData);
   }
 
@@ -159,12 +301,118 @@ namespace PlotMM {
   {
     dx_.clear();
     dy_.clear();
+    sync_errors_();
     Curve::set_data(data);
   }
 
 
+  /*!
+    \brief Set data by copying the values of strided or interleaved
+    arrays, without error values
+    \sa Curve::set_data(const StridedArray &, const StridedArray &)
+    */
+  void ErrorCurve::set_data(const StridedArray &xData,
+      const StridedArray &yData)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_data(xData, yData);
+  }
+
+  /*!
+    \brief Set data and error values by copying strided or interleaved
+    arrays
+
+    Empty views leave the curve without error values of that axis.
+    \sa StridedArray
+    */
+  void ErrorCurve::set_data(const StridedArray &xData,
+      const StridedArray &yData,
+      const StridedArray &xErr,
+      const StridedArray &yErr)
+  {
+    xErr.copy(dx_.replace());
+    yErr.copy(dy_.replace());
+    sync_errors_();
+    drop_capacity_();
+    Curve::set_data(xData, yData);
+  }
+
+  /*!
+    \brief Set data by referencing strided or interleaved arrays,
+    without error values
+    \sa Curve::set_raw_data(const StridedArray &, const StridedArray &,
+    const sigc::slot<void> &)
+    */
+  void ErrorCurve::set_raw_data(const StridedArray &xData,
+      const StridedArray &yData, const sigc::slot<void> &release)
+  {
+    dx_.clear();
+    dy_.clear();
+    sync_errors_();
+    Curve::set_raw_data(xData, yData, release);
+  }
+
+  /*!
+    \brief Set data and error values by referencing strided or
+    interleaved arrays
+
+    Nothing is copied, the error values are read through \a xErr and
+    \a yErr while drawing.  All arrays must stay valid until
+    \a release is called.  Empty views leave the curve without error
+    values of that axis.
+
+    \sa Curve::set_raw_data(const StridedArray &, const StridedArray &,
+    const sigc::slot<void> &)
+    */
+  void ErrorCurve::set_raw_data(const StridedArray &xData,
+      const StridedArray &yData,
+      const StridedArray &xErr,
+      const StridedArray &yErr,
+      const sigc::slot<void> &release)
+  {
+    dx_.clear();
+    dy_.clear();
+    dxp_ = xErr;
+    dyp_ = yErr;
+    drop_capacity_();
+    Curve::set_raw_data(xData, yData, release);
+  }
+
+  /*!
+    \brief Limit the number of samples
+
+    A curve with error values keeps no ring buffer, since appended
+    samples carry no error values.  Setting error values removes the
+    capacity, and no capacity is set while the curve has them.
+
+    \sa Curve::set_capacity
+    */
+  void ErrorCurve::set_capacity(int n)
+  {
+    Curve::set_capacity((dxp_.size() || dyp_.size()) ? 0 : n);
+  }
+
+  //! Remove the capacity if the curve has error values
+  void ErrorCurve::drop_capacity_()
+  {
+    if ((dxp_.size() || dyp_.size()) && capacity() > 0)
+      Curve::set_capacity(0);
+  }
+
+  //! Point the error views to the curve's own error values
+  void ErrorCurve::sync_errors_()
+  {
+    dxp_ = StridedArray(dx_.data(), dx_.size());
+    dyp_ = StridedArray(dy_.data(), dy_.size());
+  }
+
   /*!
     \brief Draw error bars
+
+    The bar ends are mapped in chunks with the batch transforms of
+    DoubleIntMap.  Strided error values are gathered per chunk.
     */
   void ErrorCurve::draw_errors_(
       const Cairo::RefPtr<Cairo::Context> &cr,
@@ -175,20 +423,39 @@ namespace PlotMM {
   {
     if (!have_dx_() && !have_dy_())
       return;
-    if (symbol()->size()) {
-      for (int i = from; i <= to; i++) {
-        if (have_dx_()) {
-          int xl = xMap.transform(x(i) - dx(i));
-          int y0 = yMap.transform(y(i));
-          int xu = xMap.transform(x(i) + dx(i));
-          draw_x_error_(cr, painter, xl, y0, xu, y0);
-        }
-        if (have_dy_()) {
-          int yl = yMap.transform(y(i) - dy(i));
-          int x0 = xMap.transform(x(i));
-          int yu = yMap.transform(y(i) + dy(i));
-          draw_y_error_(cr, painter, x0, yl, x0, yu);
-        }
+    if (!symbol()->size())
+      return;
+
+    const bool hx = have_dx_(), hy = have_dy_();
+    int x0[ErrorChunk], y0[ErrorChunk], lo[ErrorChunk], hi[ErrorChunk];
+    double xv[ErrorChunk], yv[ErrorChunk], ev[ErrorChunk], buf[ErrorChunk];
+
+    for (int i = from; i <= to; i += ErrorChunk) {
+      const int n = std::min(ErrorChunk, to - i + 1);
+      transform(xMap, yMap, i, n, x0, y0);
+      fetch(i, n, xv, yv);
+
+      if (hx) {
+        dxp_.copy(i, n, ev);
+        for (int k = 0; k < n; k++)
+          buf[k] = xv[k] - ev[k];
+        xMap.transform(buf, lo, n);
+        for (int k = 0; k < n; k++)
+          buf[k] = xv[k] + ev[k];
+        xMap.transform(buf, hi, n);
+        for (int k = 0; k < n; k++)
+          draw_x_error_(cr, painter, lo[k], y0[k], hi[k], y0[k]);
+      }
+      if (hy) {
+        dyp_.copy(i, n, ev);
+        for (int k = 0; k < n; k++)
+          buf[k] = yv[k] - ev[k];
+        yMap.transform(buf, lo, n);
+        for (int k = 0; k < n; k++)
+          buf[k] = yv[k] + ev[k];
+        yMap.transform(buf, hi, n);
+        for (int k = 0; k < n; k++)
+          draw_y_error_(cr, painter, x0[k], lo[k], x0[k], hi[k]);
       }
     }
   }
@@ -255,6 +522,9 @@ namespace PlotMM {
     \param to index of the last point to be painted. If to < 0 the
     curve will be painted to its last point.
 
+    Like the curve, error bars are culled to the x range of \a xMap
+    for monotonic x, see Curve::visible_range_.
+
     \sa Curve::draw,
     ErrorCurve::draw_x_error_,
     ErrorCurve::draw_x_error_,
@@ -274,7 +544,10 @@ namespace PlotMM {
       to = data_size() - 1;
 
     if ( verify_range(from, to) > 0 ) {
-      draw_errors_(cr, painter, xMap, yMap, from, to);
+      // only the bars of samples inside the x range of the map
+      int first = from, last = to;
+      visible_range_(xMap, first, last);
+      draw_errors_(cr, painter, xMap, yMap, first, last);
     }
     Curve::draw(cr, painter, xMap, yMap, from, to);
   }
@@ -0,0 +1,229 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "framereader.h"
+
+namespace PlotMM {
+
+  /*!
+    \brief Constructor
+    \param bufferSize initial size of the read buffer in bytes, it
+    grows for larger frames
+    */
+  FrameReader::FrameReader(size_t bufferSize)
+    : fd_(-1), buffer_((std::max<size_t>(bufferSize, 64) + 7) / 8),
+      fill_(0), frames_(0), skipped_(0)
+  {
+  }
+
+  //! Destructor, closes the descriptor
+  FrameReader::~FrameReader()
+  {
+    close_(false);
+  }
+
+  /*!
+    \brief Read frames from a FIFO
+
+    The FIFO is opened for reading and writing, which keeps it open
+    while writers come and go.
+
+    \param path path of the FIFO
+    \return false if it could not be opened
+    */
+  bool FrameReader::open_fifo(const std::string &path)
+  {
+    const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+    return fd >= 0 && attach(fd);
+  }
+
+  /*!
+    \brief Read frames from a UNIX domain stream socket
+    \param path path the socket is bound to
+    \return false if the connection failed
+    */
+  bool FrameReader::connect(const std::string &path)
+  {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path))
+      return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path.c_str());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+      return false;
+    if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr),
+            sizeof(addr)) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+    return attach(fd);
+  }
+
+  /*!
+    \brief Read frames from a descriptor
+
+    The descriptor is made non-blocking and closed by the reader.
+
+    \param fd an open descriptor, like an accepted connection
+    \return false if \a fd is invalid
+    */
+  bool FrameReader::attach(int fd)
+  {
+    close_(false);
+
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    fd_ = fd;
+    ioConnection_ = Glib::signal_io().connect(
+        sigc::mem_fun(*this, &FrameReader::on_io_), fd_,
+        Glib::IO_IN | Glib::IO_HUP | Glib::IO_ERR);
+    return true;
+  }
+
+  //! Stop reading and close the descriptor
+  void FrameReader::close()
+  {
+    close_(false);
+  }
+
+  //! Close the descriptor, emitting signal_closed if \a notify is set
+  void FrameReader::close_(bool notify)
+  {
+    if (fd_ < 0)
+      return;
+
+    ioConnection_.disconnect();
+    ::close(fd_);
+    fd_ = -1;
+    fill_ = 0;
+    if (notify)
+      signal_closed();
+  }
+
+  /*!
+    \brief Append the samples of \a channel to \a curve
+    \param channel channel id of the frames
+    \param curve the curve, or a null pointer to skip the channel
+    */
+  void FrameReader::set_curve(uint32_t channel, const Glib::RefPtr<Curve> &curve)
+  {
+    if (curve)
+      curves_[channel] = curve;
+    else
+      curves_.erase(channel);
+  }
+
+  //! Return the curve of \a channel, a null pointer if there is none
+  Glib::RefPtr<Curve> FrameReader::curve(uint32_t channel) const
+  {
+    std::map<uint32_t, Glib::RefPtr<Curve> >::const_iterator it =
+      curves_.find(channel);
+    return (it != curves_.end()) ? it->second : Glib::RefPtr<Curve>();
+  }
+
+  //! Handle a wakeup of the main loop
+  bool FrameReader::on_io_(Glib::IOCondition)
+  {
+    return read_();
+  }
+
+  /*!
+    \brief Read once and dispatch the complete frames
+    \return false if the reader was closed
+    */
+  bool FrameReader::read_()
+  {
+    char *data = reinterpret_cast<char *>(buffer_.data());
+    const ssize_t n = ::read(fd_, data + fill_,
+        buffer_.size() * sizeof(uint64_t) - fill_);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR))
+      return true;
+    if (n <= 0)
+    {
+      close_(true);
+      return false;
+    }
+    fill_ += n;
+
+    const int frames = dispatch_();
+    if (frames < 0)
+    {
+      close_(true);
+      return false;
+    }
+    if (frames > 0)
+      signal_received();
+    return true;
+  }
+
+  /*!
+    \brief Append the complete frames in the buffer to their curves
+
+    The rest of the buffer moves to its start, which keeps frames
+    aligned to doubles.  The buffer grows if the next frame does not
+    fit into it.
+
+    \return number of frames dispatched, -1 for a frame that is too large
+    */
+  int FrameReader::dispatch_()
+  {
+    const char *data = reinterpret_cast<const char *>(buffer_.data());
+    size_t pos = 0, pending = 0;
+    int dispatched = 0;
+    while (fill_ - pos >= sizeof(FrameHeader))
+    {
+      FrameHeader h;
+      memcpy(&h, data + pos, sizeof(h));
+      if (h.count > MaxFrameSamples)
+        return -1;
+
+      const size_t bytes = sizeof(h) + 2 * sizeof(double) * h.count;
+      if (fill_ - pos < bytes)
+      {
+        pending = bytes;
+        break;
+      }
+
+      std::map<uint32_t, Glib::RefPtr<Curve> >::iterator it =
+        curves_.find(h.channel);
+      if (it == curves_.end())
+        skipped_++;
+      else
+      {
+        const double *x = reinterpret_cast<const double *>(data + pos + sizeof(h));
+        it->second->append(x, x + h.count, h.count);
+        frames_++;
+        dispatched++;
+      }
+      pos += bytes;
+    }
+
+    fill_ -= pos;
+    memmove(buffer_.data(), data + pos, fill_);
+    if (pending > buffer_.size() * sizeof(uint64_t))
+      buffer_.resize((pending + 7) / 8);
+    return dispatched;
+  }
+
+} //namespace PlotMM
@@ -0,0 +1,272 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mappedseriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    int advice(MappedAccess access)
+    {
+      switch (access)
+      {
+        case MAPPED_SEQUENTIAL:
+          return MADV_SEQUENTIAL;
+        case MAPPED_RANDOM:
+          return MADV_RANDOM;
+        default:
+          return MADV_NORMAL;
+      }
+    }
+
+  }
+
+  //! Constructor, no file is mapped
+  MappedSeriesData::MappedSeriesData()
+    : map_(0), mapSize_(0), access_(MAPPED_NORMAL)
+  {
+  }
+
+  //! Destructor, unmaps the file
+  MappedSeriesData::~MappedSeriesData()
+  {
+    close();
+  }
+
+  /*!
+    \brief Map a file
+
+    The file is mapped as a whole, read-only.  The layout has to be
+    set before the samples can be read.
+
+    \param path path of the file
+    \return false if the file could not be opened or mapped
+    \sa MappedSeriesData::set_columns, MappedSeriesData::set_records
+    */
+  bool MappedSeriesData::open(const std::string &path)
+  {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    void *p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+      p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file referenced
+    ::close(fd);
+    if (p == MAP_FAILED)
+      return false;
+
+    map_ = static_cast<const char *>(p);
+    mapSize_ = st.st_size;
+    advise_(access_);
+    return true;
+  }
+
+  //! Unmap the file, the series is empty afterwards
+  void MappedSeriesData::close()
+  {
+    if (!map_)
+      return;
+
+    x_ = StridedArray();
+    y_ = StridedArray();
+    munmap(const_cast<char *>(map_), mapSize_);
+    map_ = 0;
+    mapSize_ = 0;
+    signal_changed();
+  }
+
+  //! Check that \a size values spaced by \a stride fit into the file
+  bool MappedSeriesData::fits_(size_t offset, int stride, int size) const
+  {
+    if (!map_ || size < 0 || stride < static_cast<int>(sizeof(double)))
+      return false;
+    if (size == 0)
+      return true;
+    if (offset > mapSize_ || mapSize_ - offset < sizeof(double))
+      return false;
+    // the last value has to end within the file
+    return static_cast<size_t>(size - 1)
+      <= (mapSize_ - offset - sizeof(double)) / stride;
+  }
+
+  /*!
+    \brief Read the samples as two columns of doubles
+    \param xOffset byte offset of the first x value
+    \param yOffset byte offset of the first y value
+    \param size number of samples
+    \return false if the columns do not fit into the file
+    */
+  bool MappedSeriesData::set_columns(size_t xOffset, size_t yOffset, int size)
+  {
+    if (!fits_(xOffset, sizeof(double), size)
+        || !fits_(yOffset, sizeof(double), size))
+      return false;
+
+    x_ = StridedArray(reinterpret_cast<const double *>(map_ + xOffset), size);
+    y_ = StridedArray(reinterpret_cast<const double *>(map_ + yOffset), size);
+    signal_changed();
+    return true;
+  }
+
+  /*!
+    \brief Read the samples from fixed size records
+    \param offset byte offset of the first record
+    \param recordSize size of a record in bytes
+    \param xField byte offset of the x value within a record
+    \param yField byte offset of the y value within a record
+    \param size number of records, -1 for as many as the file holds
+    \return false if the records do not fit into the file
+    */
+  bool MappedSeriesData::set_records(size_t offset, int recordSize,
+      int xField, int yField, int size)
+  {
+    if (!map_ || recordSize <= 0 || offset > mapSize_
+        || xField < 0 || yField < 0
+        || xField + sizeof(double) > static_cast<size_t>(recordSize)
+        || yField + sizeof(double) > static_cast<size_t>(recordSize))
+      return false;
+    if (size < 0)
+      size = (mapSize_ - offset) / recordSize;
+    if (!fits_(offset + xField, recordSize, size)
+        || !fits_(offset + yField, recordSize, size))
+      return false;
+
+    x_ = StridedArray(reinterpret_cast<const double *>(map_ + offset + xField),
+        size, recordSize);
+    y_ = StridedArray(reinterpret_cast<const double *>(map_ + offset + yField),
+        size, recordSize);
+    signal_changed();
+    return true;
+  }
+
+  /*!
+    \brief Set the access pattern hint for the mapping
+    \sa MappedAccess
+    */
+  void MappedSeriesData::set_access(MappedAccess access)
+  {
+    access_ = access;
+    advise_(access_);
+  }
+
+  /*!
+    \brief Ask the kernel to read the samples [from, from + n) ahead
+
+    Useful before jumping to a region of the recording.
+    */
+  void MappedSeriesData::will_need(int from, int n) const
+  {
+    advise_range_(x_, from, n, MADV_WILLNEED);
+    advise_range_(y_, from, n, MADV_WILLNEED);
+  }
+
+  //! Pass an access pattern for the whole mapping to the kernel
+  void MappedSeriesData::advise_(MappedAccess access) const
+  {
+    if (map_)
+      madvise(const_cast<char *>(map_), mapSize_, advice(access));
+  }
+
+  //! Pass \a advice for the pages of the values [from, from + n)
+  void MappedSeriesData::advise_range_(const StridedArray &a, int from, int n,
+      int advice) const
+  {
+    from = std::max(from, 0);
+    n = std::min(n, a.size() - from);
+    if (n <= 0)
+      return;
+
+    const long page = sysconf(_SC_PAGESIZE);
+    const char *first = reinterpret_cast<const char *>(a.data())
+      + from * static_cast<long>(a.stride());
+    const char *last = first + (n - 1) * static_cast<long>(a.stride())
+      + sizeof(double);
+    const size_t begin = (first - map_) / page * page;
+    madvise(const_cast<char *>(map_) + begin, last - map_ - begin, advice);
+  }
+
+  //! Return the number of samples
+  int MappedSeriesData::size() const
+  {
+    return std::min(x_.size(), y_.size());
+  }
+
+  //! \copydoc SeriesData::fetch
+  void MappedSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    x_.copy(from, n, x);
+    y_.copy(from, n, y);
+  }
+
+  /*!
+    \brief Give direct access to consecutive samples
+
+    Only possible for the columnar layout.
+    \sa SeriesData::span
+    */
+  int MappedSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    if (!x_.contiguous() || !y_.contiguous())
+      return 0;
+
+    x = x_.data() + from;
+    y = y_.data() + from;
+    return std::min(n, size() - from);
+  }
+
+  //! Return the x value of sample \a i
+  double MappedSeriesData::x(int i) const
+  {
+    return x_[i];
+  }
+
+  //! Return the y value of sample \a i
+  double MappedSeriesData::y(int i) const
+  {
+    return y_[i];
+  }
+
+  /*!
+    \brief Find the bounds of the samples, reading the file sequentially
+    \sa SeriesData::bounds
+    */
+  bool MappedSeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    advise_(MAPPED_SEQUENTIAL);
+    const bool valid = SeriesData::bounds(xmin, xmax, ymin, ymax);
+    advise_(access_);
+    return valid;
+  }
+
+  /*!
+    \brief Check the x values for monotony, reading the file
+    sequentially
+    \sa SeriesData::monotonic
+    */
+  int MappedSeriesData::monotonic() const
+  {
+    advise_(MAPPED_SEQUENTIAL);
+    const int mono = SeriesData::monotonic();
+    advise_(access_);
+    return mono;
+  }
+
+} //namespace PlotMM
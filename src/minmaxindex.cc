@@ -0,0 +1,436 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+#include "supplemental.h"
+#include "minmaxindex.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    // serialized header: shift, first, size, mono, levels, then xlast
+    const size_t HeaderSize = 5 * sizeof(int32_t) + 4 + sizeof(double);
+    // per level: offset and number of nodes
+    const size_t LevelSize = 2 * sizeof(int32_t);
+
+    void put(char *&out, int32_t v)
+    {
+      memcpy(out, &v, sizeof(v));
+      out += sizeof(v);
+    }
+
+    int32_t get(const char *&in)
+    {
+      int32_t v;
+      memcpy(&v, in, sizeof(v));
+      in += sizeof(v);
+      return v;
+    }
+
+  }
+
+  /*!
+    \brief Constructor
+    \param blockSize number of samples aggregated by a level 0 node.
+    It is rounded up to the next power of two.
+    */
+  MinMaxIndex::MinMaxIndex(int blockSize)
+  {
+    shift_ = 0;
+    while ((1 << shift_) < blockSize)
+      shift_++;
+    clear();
+  }
+
+  //! Destructor
+  MinMaxIndex::~MinMaxIndex()
+  {
+  }
+
+  //! Remove all samples from the index
+  void MinMaxIndex::clear()
+  {
+    first_ = 0;
+    size_ = 0;
+    mono_ = 2;
+    xlast_ = 0.0;
+    levels_.clear();
+    offsets_.clear();
+  }
+
+  //! Return a node that aggregates no samples
+  MinMaxIndex::Node MinMaxIndex::empty_node()
+  {
+    Node n;
+    n.xmin = n.ymin = HUGE_VAL;
+    n.xmax = n.ymax = -HUGE_VAL;
+    n.yfirst = n.ylast = 0.0;
+    n.imin = n.imax = -1;
+    return n;
+  }
+
+  /*!
+    \brief Merge node \a m, which follows \a n in index order, into \a n
+
+    NaN values never become extremes, nodes without valid samples are
+    recognized by imin < 0.
+    */
+  void MinMaxIndex::merge(Node &n, const Node &m)
+  {
+    if (m.imin < 0)
+      return;
+    if (n.imin < 0)
+    {
+      n = m;
+      return;
+    }
+    n.xmin = std::min(n.xmin, m.xmin);
+    n.xmax = std::max(n.xmax, m.xmax);
+    if (m.ymin < n.ymin) { n.ymin = m.ymin; n.imin = m.imin; }
+    if (m.ymax > n.ymax) { n.ymax = m.ymax; n.imax = m.imax; }
+    n.ylast = m.ylast;
+  }
+
+  /*!
+    \brief Append samples to the index
+    \param x pointer to x values
+    \param y pointer to y values
+    \param n number of samples
+
+    Only the last partial level 0 node, the new nodes and their
+    parents are recomputed.
+    */
+  void MinMaxIndex::append(const double *x, const double *y, int n)
+  {
+    if (n <= 0)
+      return;
+    if (levels_.empty())
+    {
+      levels_.resize(1);
+      offsets_.assign(1, (first_ + size_) >> shift_);
+    }
+
+    std::deque<Node> &l0 = levels_[0];
+    const int j0 = (first_ + size_) >> shift_;
+
+    for (int i = 0; i < n; i++, size_++)
+    {
+      const int k = first_ + size_;
+      if (mono_ != 0 && size_ > 0)
+      {
+        const int s = SIGN(x[i] - xlast_);
+        if (mono_ == 2)
+          mono_ = s;
+        else if (s != mono_)
+          mono_ = 0;
+      }
+      xlast_ = x[i];
+
+      const int j = k >> shift_;
+      if (j == end_node(0))
+      {
+        l0.push_back(empty_node());
+        l0.back().yfirst = y[i];
+      }
+
+      Node &nd = l0.back();
+      if (x[i] < nd.xmin) nd.xmin = x[i];
+      if (x[i] > nd.xmax) nd.xmax = x[i];
+      if (y[i] < nd.ymin) { nd.ymin = y[i]; nd.imin = k; }
+      if (y[i] > nd.ymax) { nd.ymax = y[i]; nd.imax = k; }
+      nd.ylast = y[i];
+    }
+
+    update_levels_(j0);
+  }
+
+  /*!
+    \brief Recompute all nodes above level 0 that depend on level 0
+    nodes j0 and later
+    */
+  void MinMaxIndex::update_levels_(int j0)
+  {
+    for (unsigned int lv = 1; levels_[lv - 1].size() > 1; lv++)
+    {
+      if (levels_.size() <= lv)
+      {
+        levels_.resize(lv + 1);
+        offsets_.push_back(offsets_[lv - 1] >> 1);
+      }
+
+      const int b0 = first_node(lv - 1), b1 = end_node(lv - 1);
+      std::deque<Node> &level = levels_[lv];
+      level.resize(((b1 + 1) >> 1) - offsets_[lv]);
+
+      // children that were evicted already count as empty
+      j0 = std::max(j0 >> 1, offsets_[lv]);
+      for (int j = j0; j < end_node(lv); j++)
+      {
+        Node &nd = level[j - offsets_[lv]];
+        nd = empty_node();
+        if (2 * j >= b0)
+          nd = node(lv - 1, 2 * j);
+        if (2 * j + 1 >= b0 && 2 * j + 1 < b1)
+          merge(nd, node(lv - 1, 2 * j + 1));
+      }
+    }
+  }
+
+  /*!
+    \brief Remove the oldest samples from the index
+
+    Nodes are dropped once all of their samples are evicted.  Evicting
+    does not make the index recognize a series as monotonic again.
+
+    \param n number of samples to remove
+    */
+  void MinMaxIndex::evict(int n)
+  {
+    n = std::min(n, size_);
+    if (n <= 0)
+      return;
+
+    first_ += n;
+    size_ -= n;
+    if (size_ == 0)
+    {
+      levels_.clear();
+      offsets_.clear();
+      mono_ = 2;
+    }
+
+    for (int lv = 0; lv < levels(); lv++)
+    {
+      const int j = first_ >> (shift_ + lv);
+      while (offsets_[lv] < j)
+      {
+        levels_[lv].pop_front();
+        offsets_[lv]++;
+      }
+    }
+
+    // levels above a single node are not needed any more
+    unsigned int keep = 1;
+    while (keep < levels_.size() && levels_[keep - 1].size() > 1)
+      keep++;
+    if (keep < levels_.size())
+    {
+      levels_.resize(keep);
+      offsets_.resize(keep);
+    }
+
+    if (first_ >= (1 << 30))
+      rebase_();
+  }
+
+  /*!
+    \brief Shift all indices down, so that they do not overflow on
+    long running sliding windows
+    */
+  void MinMaxIndex::rebase_()
+  {
+    // keep the alignment of the nodes on every level
+    const int top = shift_ + std::max(levels() - 1, 0);
+    const int d = (first_ >> top) << top;
+    if (d == 0)
+      return;
+
+    first_ -= d;
+    for (int lv = 0; lv < levels(); lv++)
+    {
+      offsets_[lv] -= d >> (shift_ + lv);
+      for (unsigned int j = 0; j < levels_[lv].size(); j++)
+      {
+        Node &nd = levels_[lv][j];
+        if (nd.imin >= 0)
+        {
+          nd.imin -= d;
+          nd.imax -= d;
+        }
+      }
+    }
+  }
+
+  /*!
+    \brief Return the coarsest level whose nodes aggregate at most
+    \a samples samples, or -1 if even level 0 is coarser
+    */
+  int MinMaxIndex::level_for(int samples) const
+  {
+    int lv = -1;
+    while (lv + 1 < levels() && block_size(lv + 1) <= samples)
+      lv++;
+    return lv;
+  }
+
+  /*!
+    \brief Check if the indexed x values are strictly monotonic
+    \return 1 for increasing, -1 for decreasing and 0 otherwise
+    \sa check_mono
+    */
+  int MinMaxIndex::monotonic() const
+  {
+    return (mono_ == 2) ? 0 : mono_;
+  }
+
+  /*!
+    \brief Aggregate an index range
+
+    The range is widened to whole nodes of \a level, so the result
+    may include up to block_size(level) - 1 samples on either side
+    of [a, b], including evicted ones.  Higher levels are used wherever possible, which keeps
+    the cost at O(log n).
+
+    \param a index of the first sample
+    \param b index of the last sample
+    \param level resolution of the answer
+    */
+  MinMaxIndex::Node MinMaxIndex::range(int a, int b, int level) const
+  {
+    Node left = empty_node(), right = empty_node();
+    if (size_ <= 0 || level >= levels())
+      return left;
+
+    a = value_limits(a, first_, first_ + size_ - 1);
+    b = value_limits(b, first_, first_ + size_ - 1);
+    sort_values(a, b);
+
+    // nodes are merged from both ends inwards to keep index order
+    int lo = a >> (shift_ + level);
+    int hi = b >> (shift_ + level);
+    for (int lv = level; lo <= hi; lv++, lo >>= 1, hi >>= 1)
+    {
+      if (lo & 1)
+        merge(left, node(lv, lo++));
+      if (!(hi & 1) && lo <= hi)
+      {
+        Node n = node(lv, hi--);
+        merge(n, right);
+        right = n;
+      }
+    }
+    merge(left, right);
+    return left;
+  }
+
+  //! Return the number of bytes written by MinMaxIndex::serialize
+  size_t MinMaxIndex::serialized_size() const
+  {
+    size_t bytes = HeaderSize;
+    for (int lv = 0; lv < levels(); lv++)
+      bytes += LevelSize + levels_[lv].size() * sizeof(Node);
+    return bytes;
+  }
+
+  /*!
+    \brief Write the index to \a out
+    \param out buffer of MinMaxIndex::serialized_size bytes
+    */
+  void MinMaxIndex::serialize(char *out) const
+  {
+    put(out, shift_);
+    put(out, first_);
+    put(out, size_);
+    put(out, mono_);
+    put(out, levels());
+    memset(out, 0, 4);
+    out += 4;
+    memcpy(out, &xlast_, sizeof(double));
+    out += sizeof(double);
+
+    for (int lv = 0; lv < levels(); lv++)
+    {
+      put(out, offsets_[lv]);
+      put(out, levels_[lv].size());
+    }
+    for (int lv = 0; lv < levels(); lv++)
+      for (unsigned int j = 0; j < levels_[lv].size(); j++, out += sizeof(Node))
+        memcpy(out, &levels_[lv][j], sizeof(Node));
+  }
+
+  /*!
+    \brief Restore an index written by MinMaxIndex::serialize
+
+    The buffer is checked for consistency with the block size of this
+    index.  The index is left untouched if it does not match.
+
+    \param in serialized index
+    \param bytes size of the buffer
+    \return false if the buffer does not hold a matching index
+    */
+  bool MinMaxIndex::deserialize(const char *in, size_t bytes)
+  {
+    if (bytes < HeaderSize)
+      return false;
+
+    const char *end = in + bytes;
+    const int shift = get(in);
+    const int first = get(in);
+    const int size = get(in);
+    const int mono = get(in);
+    const int nlevels = get(in);
+    double xlast;
+    in += 4;
+    memcpy(&xlast, in, sizeof(double));
+    in += sizeof(double);
+
+    if (shift != shift_ || first < 0 || size < 0 || nlevels < 0
+        || nlevels > 32 || (nlevels == 0) != (size == 0)
+        || static_cast<size_t>(end - in) < nlevels * LevelSize)
+      return false;
+
+    // the node counts have to match the samples, level by level
+    std::vector<int> offsets(nlevels), counts(nlevels);
+    size_t nodes = 0;
+    for (int lv = 0; lv < nlevels; lv++)
+    {
+      offsets[lv] = get(in);
+      counts[lv] = get(in);
+      const int b = shift + lv;
+      const int expected = lv == 0
+        ? ((first + size - 1) >> b) + 1 - offsets[lv]
+        : ((offsets[lv - 1] + counts[lv - 1] + 1) >> 1) - offsets[lv];
+      if (counts[lv] != expected || offsets[lv] > (first >> b)
+          || (lv > 0 && offsets[lv] != (offsets[lv - 1] >> 1)))
+        return false;
+      nodes += counts[lv];
+    }
+    if (static_cast<size_t>(end - in) != nodes * sizeof(Node))
+      return false;
+
+    clear();
+    first_ = first;
+    size_ = size;
+    mono_ = mono;
+    xlast_ = xlast;
+    offsets_ = offsets;
+    levels_.resize(nlevels);
+    for (int lv = 0; lv < nlevels; lv++)
+    {
+      std::deque<Node> &level = levels_[lv];
+      level.resize(counts[lv]);
+      for (int j = 0; j < counts[lv]; j++, in += sizeof(Node))
+        memcpy(&level[j], in, sizeof(Node));
+    }
+    return true;
+  }
+
+  /*!
+    \brief Return the aggregate of all samples
+    \sa MinMaxIndex::range
+    */
+  MinMaxIndex::Node MinMaxIndex::root() const
+  {
+    return range(first_, first_ + size_ - 1);
+  }
+
+} //namespace PlotMM
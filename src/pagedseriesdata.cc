@@ -0,0 +1,541 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "pagedseriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    // default memory budget of the page cache
+    const size_t DefaultBudget = 64 << 20;
+
+    /* Read exactly n bytes at offset, false on errors and short files */
+    bool read_at(int fd, char *buf, size_t n, size_t offset)
+    {
+      while (n > 0)
+      {
+        const ssize_t r = pread(fd, buf, n, offset);
+        if (r <= 0)
+          return false;
+        buf += r;
+        n -= r;
+        offset += r;
+      }
+      return true;
+    }
+
+    /* Write n bytes, false on errors */
+    bool write_all(int fd, const char *buf, size_t n)
+    {
+      while (n > 0)
+      {
+        const ssize_t r = write(fd, buf, n);
+        if (r <= 0)
+          return false;
+        buf += r;
+        n -= r;
+      }
+      return true;
+    }
+
+    /* FNV-1a over 64 bit words, the remaining bytes one by one */
+    uint64_t hash_bytes(uint64_t h, const void *data, size_t n)
+    {
+      const uint64_t prime = 1099511628211ULL;
+      const char *p = static_cast<const char *>(data);
+      for (; n >= sizeof(uint64_t); n -= sizeof(uint64_t))
+      {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        p += sizeof(w);
+        h = (h ^ w) * prime;
+      }
+      for (; n > 0; n--)
+        h = (h ^ static_cast<unsigned char>(*p++)) * prime;
+      return h;
+    }
+
+    // "PMMLOD" and the version of the sidecar format
+    const char SidecarMagic[8] = { 'P', 'M', 'M', 'L', 'O', 'D', 0, 1 };
+
+    /* Header of a sidecar file, followed by the serialized index */
+    struct SidecarHeader
+    {
+      char magic[8];
+      uint64_t fileSize;      // of the data file
+      int64_t mtime, mtimeNsec;
+      uint64_t xOffset, yOffset;
+      int32_t stride, size;
+      uint64_t bytes;         // of the serialized index
+      uint64_t hash;          // of all of the above, see hash_
+    };
+
+  }
+
+  /*!
+    \brief Constructor
+    \param pageSize number of samples per page
+    \param summaryBlock number of samples per summary, rounded up to
+    a power of two
+    */
+  PagedSeriesData::PagedSeriesData(int pageSize, int summaryBlock)
+    : fd_(-1), fileSize_(0), mtime_(0), mtimeNsec_(0),
+      xOffset_(0), yOffset_(0),
+      stride_(sizeof(double)), size_(0),
+      pageSize_(std::max(pageSize, 1)), budget_(DefaultBudget),
+      summary_(summaryBlock), sidecarLoaded_(false)
+  {
+  }
+
+  //! Destructor, closes the file
+  PagedSeriesData::~PagedSeriesData()
+  {
+    close();
+  }
+
+  /*!
+    \brief Open a file
+
+    The layout has to be set before the samples can be read.
+
+    \param path path of the file
+    \return false if the file could not be opened
+    \sa PagedSeriesData::set_columns, PagedSeriesData::set_records
+    */
+  bool PagedSeriesData::open(const std::string &path)
+  {
+    close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+      return false;
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0)
+    {
+      close();
+      return false;
+    }
+    fileSize_ = st.st_size;
+    mtime_ = st.st_mtim.tv_sec;
+    mtimeNsec_ = st.st_mtim.tv_nsec;
+    return true;
+  }
+
+  //! Close the file, the series is empty afterwards
+  void PagedSeriesData::close()
+  {
+    if (fd_ < 0)
+      return;
+
+    ::close(fd_);
+    fd_ = -1;
+    fileSize_ = 0;
+    size_ = 0;
+    pages_.clear();
+    lookup_.clear();
+    std::vector<char>().swap(records_);
+    summary_.clear();
+    sidecarLoaded_ = false;
+    signal_changed();
+  }
+
+  /*!
+    \brief Read the samples as two columns of doubles
+    \param xOffset byte offset of the first x value
+    \param yOffset byte offset of the first y value
+    \param size number of samples
+    \return false if the columns do not fit into the file
+    */
+  bool PagedSeriesData::set_columns(size_t xOffset, size_t yOffset, int size)
+  {
+    return set_layout_(xOffset, yOffset, sizeof(double), size);
+  }
+
+  /*!
+    \brief Read the samples from fixed size records
+    \param offset byte offset of the first record
+    \param recordSize size of a record in bytes
+    \param xField byte offset of the x value within a record
+    \param yField byte offset of the y value within a record
+    \param size number of records, -1 for as many as the file holds
+    \return false if the records do not fit into the file
+    */
+  bool PagedSeriesData::set_records(size_t offset, int recordSize,
+      int xField, int yField, int size)
+  {
+    if (fd_ < 0 || recordSize <= 0 || offset > fileSize_
+        || xField < 0 || yField < 0
+        || xField + sizeof(double) > static_cast<size_t>(recordSize)
+        || yField + sizeof(double) > static_cast<size_t>(recordSize))
+      return false;
+    if (size < 0)
+      size = (fileSize_ - offset) / recordSize;
+
+    return set_layout_(offset + xField, offset + yField, recordSize, size);
+  }
+
+  /*!
+    \brief Check and set the layout, then scan the file for the
+    summaries
+    */
+  bool PagedSeriesData::set_layout_(size_t xOffset, size_t yOffset,
+      int stride, int size)
+  {
+    if (fd_ < 0 || size < 0 || stride < static_cast<int>(sizeof(double)))
+      return false;
+    for (int k = 0; size > 0 && k < 2; k++)
+    {
+      const size_t offset = k ? yOffset : xOffset;
+      if (offset > fileSize_ || fileSize_ - offset < sizeof(double)
+          || static_cast<size_t>(size - 1)
+             > (fileSize_ - offset - sizeof(double)) / stride)
+        return false;
+    }
+
+    xOffset_ = xOffset;
+    yOffset_ = yOffset;
+    stride_ = stride;
+    size_ = size;
+    pages_.clear();
+    lookup_.clear();
+
+    sidecarLoaded_ = !sidecar_.empty() && load_summary_();
+    if (!sidecarLoaded_)
+    {
+      build_summary_();
+      if (!sidecar_.empty())
+        save_summary_();
+    }
+    signal_changed();
+    return true;
+  }
+
+  /*!
+    \brief Keep the summaries in a sidecar file
+
+    Takes effect when the layout is set next.  The sidecar is usually
+    named like the data file with ".lod" appended.  It is written
+    through a temporary file, so a sidecar that is being written is
+    never read.  Failing to write it is not an error.
+
+    \param path path of the sidecar, empty to build the summaries from
+    the data every time
+    */
+  void PagedSeriesData::set_sidecar(const std::string &path)
+  {
+    sidecar_ = path;
+  }
+
+  /*!
+    \brief Hash a sidecar
+
+    Besides the header and the serialized index, the first and last
+    page of the data are hashed, which catches data rewritten with
+    the same size and time stamp.
+    */
+  uint64_t PagedSeriesData::hash_(const void *header, size_t headerSize,
+      const char *summary, size_t bytes) const
+  {
+    uint64_t h = hash_bytes(14695981039346656037ULL, header, headerSize);
+    h = hash_bytes(h, summary, bytes);
+
+    Page page;
+    const int last = size_ > 0 ? (size_ - 1) / pageSize_ : 0;
+    for (int p = 0; p <= last && size_ > 0; p += std::max(last, 1))
+    {
+      read_page_(p, page);
+      h = hash_bytes(h, page.x.data(), page.x.size() * sizeof(double));
+      h = hash_bytes(h, page.y.data(), page.y.size() * sizeof(double));
+    }
+    return h;
+  }
+
+  //! Load the summaries from the sidecar, if it matches the data
+  bool PagedSeriesData::load_summary_()
+  {
+    const int fd = ::open(sidecar_.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+
+    bool ok = false;
+    struct stat st;
+    if (fstat(fd, &st) == 0
+        && static_cast<size_t>(st.st_size) >= sizeof(SidecarHeader))
+    {
+      void *map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED)
+      {
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+        const char *base = static_cast<const char *>(map);
+        const char *summary = base + sizeof(SidecarHeader);
+
+        SidecarHeader h;
+        memcpy(&h, base, sizeof(h));
+        const uint64_t hash = h.hash;
+        h.hash = 0;
+        ok = memcmp(h.magic, SidecarMagic, sizeof(h.magic)) == 0
+          && h.fileSize == fileSize_
+          && h.mtime == mtime_ && h.mtimeNsec == mtimeNsec_
+          && h.xOffset == xOffset_ && h.yOffset == yOffset_
+          && h.stride == stride_ && h.size == size_
+          && h.bytes == st.st_size - sizeof(h)
+          && hash_(&h, sizeof(h), summary, h.bytes) == hash
+          && summary_.deserialize(summary, h.bytes)
+          && summary_.size() == size_;
+        munmap(map, st.st_size);
+      }
+    }
+    ::close(fd);
+
+    if (!ok)
+      summary_.clear();
+    return ok;
+  }
+
+  //! Write the summaries to the sidecar
+  bool PagedSeriesData::save_summary_() const
+  {
+    std::vector<char> summary(summary_.serialized_size());
+    summary_.serialize(summary.data());
+
+    SidecarHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SidecarMagic, sizeof(h.magic));
+    h.fileSize = fileSize_;
+    h.mtime = mtime_;
+    h.mtimeNsec = mtimeNsec_;
+    h.xOffset = xOffset_;
+    h.yOffset = yOffset_;
+    h.stride = stride_;
+    h.size = size_;
+    h.bytes = summary.size();
+    h.hash = hash_(&h, sizeof(h), summary.data(), summary.size());
+
+    const std::string tmp = sidecar_ + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+    bool ok = write_all(fd, reinterpret_cast<const char *>(&h), sizeof(h))
+      && write_all(fd, summary.data(), summary.size());
+    ok = (::close(fd) == 0) && ok
+      && rename(tmp.c_str(), sidecar_.c_str()) == 0;
+    if (!ok)
+      unlink(tmp.c_str());
+    return ok;
+  }
+
+  /*!
+    \brief Build the summaries in one sequential pass over the file
+
+    The pages are read past the cache, so the scan does not evict
+    anything.
+    */
+  void PagedSeriesData::build_summary_()
+  {
+    summary_.clear();
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    Page page;
+    for (int p = 0; p * static_cast<long>(pageSize_) < size_; p++)
+    {
+      read_page_(p, page);
+      summary_.append(page.x.data(), page.y.data(), page.x.size());
+    }
+
+    // the pages are read in the order the curves ask for them
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_RANDOM);
+  }
+
+  /*!
+    \brief Read page \a p from the file
+
+    Samples that cannot be read are NaN.
+    \return false on read errors
+    */
+  bool PagedSeriesData::read_page_(int p, Page &page) const
+  {
+    const int from = p * pageSize_;
+    const int n = std::min(pageSize_, size_ - from);
+    page.index = p;
+    page.x.resize(n);
+    page.y.resize(n);
+
+    bool ok = true;
+    if (stride_ == sizeof(double))
+    {
+      ok = read_at(fd_, reinterpret_cast<char *>(page.x.data()),
+          n * sizeof(double), xOffset_ + from * sizeof(double))
+        && read_at(fd_, reinterpret_cast<char *>(page.y.data()),
+            n * sizeof(double), yOffset_ + from * sizeof(double));
+    }
+    else
+    {
+      // both fields lie in the same records, which are read at once
+      const size_t first = std::min(xOffset_, yOffset_);
+      const size_t dx = xOffset_ - first, dy = yOffset_ - first;
+      const size_t bytes = (n - 1) * static_cast<size_t>(stride_)
+        + std::max(dx, dy) + sizeof(double);
+      records_.resize(bytes);
+      ok = read_at(fd_, records_.data(), bytes,
+          first + from * static_cast<size_t>(stride_));
+
+      const char *r = records_.data();
+      for (int i = 0; ok && i < n; i++, r += stride_)
+      {
+        std::copy(r + dx, r + dx + sizeof(double),
+            reinterpret_cast<char *>(&page.x[i]));
+        std::copy(r + dy, r + dy + sizeof(double),
+            reinterpret_cast<char *>(&page.y[i]));
+      }
+    }
+
+    if (!ok)
+    {
+      std::fill(page.x.begin(), page.x.end(), NAN);
+      std::fill(page.y.begin(), page.y.end(), NAN);
+    }
+    return ok;
+  }
+
+  /*!
+    \brief Return page \a p, loading it if necessary
+
+    The page becomes the most recently used one.
+    */
+  const PagedSeriesData::Page &PagedSeriesData::page_(int p) const
+  {
+    std::unordered_map<int, std::list<Page>::iterator>::iterator it =
+      lookup_.find(p);
+    if (it != lookup_.end())
+    {
+      pages_.splice(pages_.begin(), pages_, it->second);
+      return pages_.front();
+    }
+
+    pages_.push_front(Page());
+    read_page_(p, pages_.front());
+    lookup_[p] = pages_.begin();
+    trim_();
+    return pages_.front();
+  }
+
+  //! Drop the least recently used pages exceeding the memory budget
+  void PagedSeriesData::trim_() const
+  {
+    const size_t bytes = 2 * sizeof(double) * pageSize_;
+    while (pages_.size() > 1 && pages_.size() * bytes > budget_)
+    {
+      lookup_.erase(pages_.back().index);
+      pages_.pop_back();
+    }
+  }
+
+  /*!
+    \brief Set the memory budget of the page cache
+
+    At least one page is kept in any case.
+    \param bytes the budget in bytes
+    */
+  void PagedSeriesData::set_memory_budget(size_t bytes)
+  {
+    budget_ = bytes;
+    trim_();
+  }
+
+  //! Return the memory used by cached pages in bytes
+  size_t PagedSeriesData::memory_used() const
+  {
+    return pages_.size() * 2 * sizeof(double) * pageSize_;
+  }
+
+  //! Return the number of samples
+  int PagedSeriesData::size() const
+  {
+    return size_;
+  }
+
+  //! \copydoc SeriesData::fetch
+  void PagedSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    for (int i = from, k; i < from + n; i += k)
+    {
+      const Page &page = page_(i / pageSize_);
+      const int o = i % pageSize_;
+      k = std::min(from + n - i, static_cast<int>(page.x.size()) - o);
+      std::copy(page.x.begin() + o, page.x.begin() + o + k, x + i - from);
+      std::copy(page.y.begin() + o, page.y.begin() + o + k, y + i - from);
+    }
+  }
+
+  /*!
+    \brief Give direct access to the samples of a page
+    \sa SeriesData::span
+    */
+  int PagedSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    const Page &page = page_(from / pageSize_);
+    const int o = from % pageSize_;
+    x = page.x.data() + o;
+    y = page.y.data() + o;
+    return std::min(n, static_cast<int>(page.x.size()) - o);
+  }
+
+  //! Return the x value of sample \a i
+  double PagedSeriesData::x(int i) const
+  {
+    return page_(i / pageSize_).x[i % pageSize_];
+  }
+
+  //! Return the y value of sample \a i
+  double PagedSeriesData::y(int i) const
+  {
+    return page_(i / pageSize_).y[i % pageSize_];
+  }
+
+  /*!
+    \brief Return the bounds from the summaries, without reading pages
+    \sa SeriesData::bounds
+    */
+  bool PagedSeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    if (summary_.size() == 0)
+      return false;
+
+    const MinMaxIndex::Node r = summary_.root();
+    xmin = r.xmin;
+    xmax = r.xmax;
+    ymin = r.ymin;
+    ymax = r.ymax;
+    return xmin <= xmax && ymin <= ymax;
+  }
+
+  //! Return the monotony of x from the summaries
+  int PagedSeriesData::monotonic() const
+  {
+    return summary_.monotonic();
+  }
+
+  //! Return the summaries as level of detail index
+  const MinMaxIndex *PagedSeriesData::lod() const
+  {
+    return &summary_;
+  }
+
+} //namespace PlotMM
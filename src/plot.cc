@@ -367,6 +367,8 @@ namespace PlotMM {
    */
   bool Plot::replot()
   {
+    // take in what producer threads have queued, before autoscaling
+    drain_curves_();
     reset_autoscale();
 
     if(!draw_select_)
@@ -419,6 +421,14 @@ namespace PlotMM {
     return true;
   }
 
+  //! Append the queued samples of all curves, see Curve::drain
+  void Plot::drain_curves_()
+  {
+    std::vector<CurveInfo>::iterator cv;
+    for (cv = plotDict_.begin(); cv != plotDict_.end(); ++cv)
+      (*cv).curve->drain();
+  }
+
   /*! Set the selection to the given rectangle.  If selection is
    *  enabled, the old rectangle is erased and the new is drawn.  Note
    *  that replot() does not have to be called explicitly.  No other
@@ -0,0 +1,316 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "rollupseriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    /* True for buckets that start before x */
+    struct StartsBefore
+    {
+      double x;
+
+      bool operator()(const RollupSeriesData::Bucket &b) const
+      {
+        return b.start < x;
+      }
+    };
+
+    /* True for buckets whose samples all lie at or before x */
+    struct EndsBy
+    {
+      double x;
+
+      bool operator()(const RollupSeriesData::Bucket &b) const
+      {
+        return std::max(b.xLow, b.xHigh) <= x;
+      }
+    };
+
+  }
+
+  /*!
+    \brief Constructor
+    \param rawSpan x range of the raw samples kept, counted back from
+    the last sample
+    */
+  RollupSeriesData::RollupSeriesData(double rawSpan)
+    : rawSpan_(std::max(rawSpan, 0.0)), resolution_(-1), size_(0)
+  {
+  }
+
+  //! Destructor
+  RollupSeriesData::~RollupSeriesData()
+  {
+  }
+
+  /*!
+    \brief Add a rollup tier
+
+    The tier consolidates the samples appended from now on.
+
+    \param width x range of a bucket
+    \param span x range of the buckets kept, counted back from the
+    last sample
+    */
+  void RollupSeriesData::add_tier(double width, double span)
+  {
+    if (!(width > 0.0))
+      return;
+
+    Tier tier;
+    tier.width = width;
+    tier.span = std::max(span, 0.0);
+
+    // keep the tiers sorted from fine to coarse
+    unsigned int t = 0;
+    while (t < tiers_.size() && tiers_[t].width <= width)
+      t++;
+    tiers_.insert(tiers_.begin() + t, tier);
+    if (resolution_ >= static_cast<int>(t))
+      resolution_++;
+
+    update_segments_();
+    signal_changed();
+  }
+
+  /*!
+    \brief Append samples
+    \param x pointer to x values
+    \param y pointer to y values
+    \param n number of samples
+    */
+  void RollupSeriesData::append(const double *x, const double *y, int n)
+  {
+    for (int i = 0; i < n; i++)
+      add_(x[i], y[i]);
+
+    update_segments_();
+    signal_changed();
+  }
+
+  //! Remove all samples and buckets, the tiers are kept
+  void RollupSeriesData::clear()
+  {
+    rawX_.clear();
+    rawY_.clear();
+    for (unsigned int t = 0; t < tiers_.size(); t++)
+      tiers_[t].buckets.clear();
+
+    update_segments_();
+    signal_changed();
+  }
+
+  //! Add a sample to the raw samples and the tiers, then apply the spans
+  void RollupSeriesData::add_(double x, double y)
+  {
+    if (x != x || (!rawX_.empty() && x < rawX_.back()))
+      return;
+
+    rawX_.push_back(x);
+    rawY_.push_back(y);
+    while (rawX_.front() < x - rawSpan_)
+    {
+      rawX_.pop_front();
+      rawY_.pop_front();
+    }
+
+    for (unsigned int t = 0; t < tiers_.size(); t++)
+    {
+      Tier &tier = tiers_[t];
+      std::deque<Bucket> &buckets = tier.buckets;
+
+      // NaN values are not consolidated
+      const double start = floor(x / tier.width) * tier.width;
+      if (y == y && (buckets.empty() || buckets.back().start != start))
+      {
+        Bucket b;
+        b.start = start;
+        b.low = b.high = b.sum = y;
+        b.xLow = b.xHigh = x;
+        b.count = 1;
+        buckets.push_back(b);
+      }
+      else if (y == y)
+      {
+        Bucket &b = buckets.back();
+        if (y < b.low) { b.low = y; b.xLow = x; }
+        if (y > b.high) { b.high = y; b.xHigh = x; }
+        b.sum += y;
+        b.count++;
+      }
+
+      while (!buckets.empty()
+             && buckets.front().start + tier.width < x - tier.span)
+        buckets.pop_front();
+    }
+  }
+
+  /*!
+    \brief Select the resolution served
+
+    The coarsest tier whose buckets are not wider than \a dx is
+    selected, the raw samples if there is none.  Curves sharing a
+    RollupSeriesData have to be drawn with the same x scale.
+
+    \sa SeriesData::set_resolution
+    */
+  bool RollupSeriesData::set_resolution(double dx)
+  {
+    int r = -1;
+    while (r + 1 < tiers() && tiers_[r + 1].width <= dx)
+      r++;
+    if (r == resolution_)
+      return false;
+
+    resolution_ = r;
+    update_segments_();
+    return true;
+  }
+
+  /*!
+    \brief Lay out the samples served
+
+    The selected resolution is served completely.  Before it, each
+    coarser tier serves the buckets that start before the data of the
+    finer ones begins.  A bucket that straddles that boundary is
+    served by the coarser tier, which covers its whole x range, and
+    the finer samples up to its last extreme are left out, so that x
+    never decreases and no x range is left uncovered.
+    */
+  void RollupSeriesData::update_segments_()
+  {
+    segments_.clear();
+    size_ = 0;
+
+    // the levels served, coarsest first, and where their data begins
+    std::vector<int> levels;
+    for (int t = tiers() - 1; t >= std::max(resolution_, 0); t--)
+      levels.push_back(t);
+    if (resolution_ < 0)
+      levels.push_back(-1);
+
+    std::vector<double> begin(levels.size() + 1, HUGE_VAL);
+    for (int k = levels.size() - 1; k >= 0; k--)
+    {
+      begin[k] = begin[k + 1];
+      if (levels[k] < 0 && !rawX_.empty())
+        begin[k] = std::min(begin[k], rawX_.front());
+      else if (levels[k] >= 0 && !tiers_[levels[k]].buckets.empty())
+        begin[k] = std::min(begin[k], tiers_[levels[k]].buckets[0].start);
+    }
+
+    // x of the last sample served by the coarser levels
+    double served = -HUGE_VAL;
+    for (unsigned int k = 0; k < levels.size(); k++)
+    {
+      Segment s = { levels[k], 0, 0 };
+      if (s.tier < 0)
+      {
+        s.first = std::upper_bound(rawX_.begin(), rawX_.end(), served)
+          - rawX_.begin();
+        s.size = rawX_.size() - s.first;
+      }
+      else
+      {
+        const std::deque<Bucket> &buckets = tiers_[s.tier].buckets;
+        const EndsBy done = { served };
+        const int skip = std::partition_point(buckets.begin(), buckets.end(),
+            done) - buckets.begin();
+        s.first = 2 * skip;
+        if (skip < static_cast<int>(buckets.size())
+            && std::min(buckets[skip].xLow, buckets[skip].xHigh) <= served)
+          s.first++;
+
+        const StartsBefore before = { begin[k + 1] };
+        const int rows = std::partition_point(buckets.begin(), buckets.end(),
+            before) - buckets.begin();
+        s.size = std::max(2 * rows - s.first, 0);
+        if (s.size > 0)
+          served = std::max(buckets[rows - 1].xLow, buckets[rows - 1].xHigh);
+      }
+      segments_.push_back(s);
+      size_ += s.size;
+    }
+  }
+
+  //! Look up sample \a i
+  void RollupSeriesData::sample_(int i, double &x, double &y) const
+  {
+    unsigned int k = 0;
+    while (k + 1 < segments_.size() && i >= segments_[k].size)
+      i -= segments_[k++].size;
+
+    const Segment &s = segments_[k];
+    i += s.first;
+    if (s.tier < 0)
+    {
+      x = rawX_[i];
+      y = rawY_[i];
+      return;
+    }
+
+    // the extreme that occurred first is served first
+    const Bucket &b = tiers_[s.tier].buckets[i / 2];
+    if ((i % 2 == 0) == (b.xLow <= b.xHigh))
+    {
+      x = b.xLow;
+      y = b.low;
+    }
+    else
+    {
+      x = b.xHigh;
+      y = b.high;
+    }
+  }
+
+  //! Return the number of samples served
+  int RollupSeriesData::size() const
+  {
+    return size_;
+  }
+
+  //! \copydoc SeriesData::fetch
+  void RollupSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    for (int i = 0; i < n; i++)
+      sample_(from + i, x[i], y[i]);
+  }
+
+  //! Return the x value of sample \a i
+  double RollupSeriesData::x(int i) const
+  {
+    double x, y;
+    sample_(i, x, y);
+    return x;
+  }
+
+  //! Return the y value of sample \a i
+  double RollupSeriesData::y(int i) const
+  {
+    double x, y;
+    sample_(i, x, y);
+    return y;
+  }
+
+  /*!
+    \brief Return 1, x never decreases
+
+    Buckets of a single sample serve it twice, so x is not strictly
+    increasing, which does not matter for finding the visible samples.
+    */
+  int RollupSeriesData::monotonic() const
+  {
+    return size_ > 1 ? 1 : 0;
+  }
+
+} //namespace PlotMM
@@ -0,0 +1,128 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "samplequeue.h"
+
+namespace PlotMM {
+
+  /*!
+    \brief Constructor
+    \param capacity number of samples, rounded up to a power of two
+    */
+  SampleQueue::SampleQueue(int capacity)
+    : head_(0), tailCache_(0), tail_(0), headCache_(0), dropped_(0)
+  {
+    size_t n = 1;
+    while (n < static_cast<size_t>(std::max(capacity, 1)))
+      n <<= 1;
+    x_.resize(n);
+    y_.resize(n);
+    mask_ = n - 1;
+  }
+
+  //! Destructor
+  SampleQueue::~SampleQueue()
+  {
+  }
+
+  /*!
+    \brief Add samples, called by the producer only
+
+    Samples that do not fit are dropped.
+
+    \param x pointer to x values
+    \param y pointer to y values
+    \param n number of samples
+    \return number of samples added
+    */
+  int SampleQueue::push(const double *x, const double *y, int n)
+  {
+    if (n <= 0)
+      return 0;
+
+    const size_t cap = mask_ + 1;
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - headCache_ + n > cap)
+      headCache_ = head_.load(std::memory_order_acquire);
+
+    const size_t k = std::min(static_cast<size_t>(n), cap - (tail - headCache_));
+    const size_t p = tail & mask_;
+    const size_t k1 = std::min(k, cap - p);
+    std::copy(x, x + k1, x_.begin() + p);
+    std::copy(y, y + k1, y_.begin() + p);
+    std::copy(x + k1, x + k, x_.begin());
+    std::copy(y + k1, y + k, y_.begin());
+
+    tail_.store(tail + k, std::memory_order_release);
+    if (k < static_cast<size_t>(n))
+      dropped_.fetch_add(n - k, std::memory_order_relaxed);
+    return k;
+  }
+
+  /*!
+    \brief Take samples out, called by the consumer only
+    \param x receives up to n x values
+    \param y receives up to n y values
+    \param n number of samples wanted
+    \return number of samples taken
+    */
+  int SampleQueue::pop(double *x, double *y, int n)
+  {
+    int taken = 0;
+    const double *xs, *ys;
+    for (int k; taken < n && (k = span(xs, ys)) > 0; taken += k)
+    {
+      k = std::min(k, n - taken);
+      std::copy(xs, xs + k, x + taken);
+      std::copy(ys, ys + k, y + taken);
+      consume(k);
+    }
+    return taken;
+  }
+
+  /*!
+    \brief Give direct access to the oldest samples, called by the
+    consumer only
+
+    The samples stay in the queue until SampleQueue::consume is called.
+
+    \param x receives a pointer to the oldest x value
+    \param y receives a pointer to the oldest y value
+    \return number of consecutive samples available
+    */
+  int SampleQueue::span(const double *&x, const double *&y)
+  {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (tailCache_ == head)
+      tailCache_ = tail_.load(std::memory_order_acquire);
+
+    const size_t p = head & mask_;
+    x = x_.data() + p;
+    y = y_.data() + p;
+    return std::min(tailCache_ - head, mask_ + 1 - p);
+  }
+
+  /*!
+    \brief Remove the oldest samples, called by the consumer only
+    \param n number of samples, at most what SampleQueue::span returned
+    */
+  void SampleQueue::consume(int n)
+  {
+    head_.store(head_.load(std::memory_order_relaxed) + n,
+        std::memory_order_release);
+  }
+
+  //! Return the number of queued samples, exact for the consumer only
+  int SampleQueue::size() const
+  {
+    return tail_.load(std::memory_order_acquire)
+      - head_.load(std::memory_order_acquire);
+  }
+
+} //namespace PlotMM
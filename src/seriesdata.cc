@@ -0,0 +1,202 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "supplemental.h"
+#include "seriesdata.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    // the default implementations scan the samples in chunks of this size
+    const int FetchChunk = 512;
+
+  }
+
+  //! Constructor
+  SeriesData::SeriesData()
+  {
+  }
+
+  //! Destructor
+  SeriesData::~SeriesData()
+  {
+  }
+
+  /*!
+    \brief Give direct access to consecutive samples
+
+    Implementations that store the samples in arrays of doubles return
+    pointers to the sample \a from and the number of samples that follow
+    it in memory, at most \a n.  The default returns 0, which makes
+    callers use fetch() instead.
+
+    \param from index of the first sample
+    \param n number of samples wanted
+    \param x receives a pointer to the x value of sample \a from
+    \param y receives a pointer to the y value of sample \a from
+    \return number of samples available through \a x and \a y
+    */
+  int SeriesData::span(int, int, const double *&, const double *&) const
+  {
+    return 0;
+  }
+
+  /*!
+    \brief Return the x value of sample \a i
+    Reading single samples is slow, use fetch() for ranges.
+    */
+  double SeriesData::x(int i) const
+  {
+    double x, y;
+    fetch(i, 1, &x, &y);
+    return x;
+  }
+
+  /*!
+    \brief Return the y value of sample \a i
+    Reading single samples is slow, use fetch() for ranges.
+    */
+  double SeriesData::y(int i) const
+  {
+    double x, y;
+    fetch(i, 1, &x, &y);
+    return y;
+  }
+
+  /*!
+    \brief Map the samples [from, from + n) into pixel coordinates
+
+    Implementations can override this to map their samples without
+    converting them to doubles first.  The default returns false,
+    which makes callers fetch the samples and map them.
+
+    \return true if \a xi and \a yi were filled
+    \sa Curve::transform
+    */
+  bool SeriesData::transform(const DoubleIntMap &, const DoubleIntMap &,
+      int, int, int *, int *) const
+  {
+    return false;
+  }
+
+  /*!
+    \brief Select the resolution of the samples
+
+    Curve::draw calls this with the x distance covered by one pixel
+    before it reads any sample.  Sources that keep their samples in
+    several resolutions serve the one that suits \a dx from then on.
+    The default does nothing.
+
+    \param dx x distance of one pixel
+    \return true if the samples served have changed
+    \sa RollupSeriesData
+    */
+  bool SeriesData::set_resolution(double)
+  {
+    return false;
+  }
+
+  /*!
+    \brief Take in changes made by other threads
+
+    Curve::drain calls this on the GUI thread.  Sources written by
+    other threads make their changes visible here and emit
+    signal_changed.  The default does nothing.
+
+    \return true if the samples have changed
+    \sa SnapshotSeriesData
+    */
+  bool SeriesData::update()
+  {
+    return false;
+  }
+
+  /*!
+    \brief Find the bounds of the samples
+
+    NaN values are skipped.  The default scans all samples.
+
+    \return false if x or y contain no value that is not NaN
+    \sa array_bounds
+    */
+  bool SeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    xmin = ymin = HUGE_VAL;
+    xmax = ymax = -HUGE_VAL;
+
+    double xb[FetchChunk], yb[FetchChunk];
+    const int size = this->size();
+    for (int i = 0; i < size; i += FetchChunk)
+    {
+      const int n = std::min(FetchChunk, size - i);
+      double x1, x2, y1, y2;
+      fetch(i, n, xb, yb);
+      array_bounds(xb, yb, n, x1, x2, y1, y2);
+      xmin = std::min(xmin, x1);
+      xmax = std::max(xmax, x2);
+      ymin = std::min(ymin, y1);
+      ymax = std::max(ymax, y2);
+    }
+    return xmin <= xmax && ymin <= ymax;
+  }
+
+  /*!
+    \brief Check if the x values are strictly monotonic
+
+    The default scans all samples.
+    \return 1 for increasing, -1 for decreasing and 0 otherwise
+    \sa check_mono
+    */
+  int SeriesData::monotonic() const
+  {
+    const int size = this->size();
+    if (size < 2)
+      return 0;
+
+    double xb[FetchChunk + 1], yb[FetchChunk + 1];
+    fetch(0, 1, xb, yb);
+
+    int rv = 2;
+    for (int i = 1; i < size && rv != 0; i += FetchChunk)
+    {
+      // xb[0] holds the last sample of the previous chunk
+      const int n = std::min(FetchChunk, size - i);
+      fetch(i, n, xb + 1, yb + 1);
+      for (int k = 0; k < n; k++)
+      {
+        const int s = SIGN(xb[k + 1] - xb[k]);
+        if (rv == 2)
+          rv = s;
+        if (s != rv)
+        {
+          rv = 0;
+          break;
+        }
+      }
+      xb[0] = xb[n];
+    }
+    return rv;
+  }
+
+  /*!
+    \brief Return a level of detail index over the samples
+
+    Sources that maintain a MinMaxIndex can return it here, curves
+    then use it instead of building their own.  The default returns 0.
+    \sa Curve::set_lod_enabled
+    */
+  const MinMaxIndex *SeriesData::lod() const
+  {
+    return 0;
+  }
+
+} //namespace PlotMM
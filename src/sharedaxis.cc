@@ -0,0 +1,128 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "sharedaxis.h"
+
+namespace PlotMM {
+
+  namespace {
+
+    bool same_map(const DoubleIntMap &a, const DoubleIntMap &b)
+    {
+      return a.d1() == b.d1() && a.d2() == b.d2()
+        && a.i1() == b.i1() && a.i2() == b.i2()
+        && a.logarithmic() == b.logarithmic();
+    }
+
+  }
+
+  //! Construct an empty axis
+  SharedAxis::SharedAxis()
+    : pixelsValid_(false), pixelsFrom_(0), pixelsTo_(0)
+  {
+  }
+
+  /*!
+    \brief Construct an axis by copying values
+    \param values pointer to the values
+    \param size number of values
+    */
+  SharedAxis::SharedAxis(const double *values, int size)
+    : pixelsValid_(false), pixelsFrom_(0), pixelsTo_(0)
+  {
+    vector_from_c(values_, values, size);
+  }
+
+  /*!
+    \brief Construct an axis by moving values into it
+    \param values the values
+    */
+  SharedAxis::SharedAxis(std::vector<double> &&values)
+    : values_(std::move(values)),
+      pixelsValid_(false), pixelsFrom_(0), pixelsTo_(0)
+  {
+  }
+
+  //! Destructor
+  SharedAxis::~SharedAxis()
+  {
+  }
+
+  /*!
+    \brief Replace the values by a copy of \a values
+    \param values pointer to the values
+    \param size number of values
+    */
+  void SharedAxis::set_values(const double *values, int size)
+  {
+    vector_from_c(values_, values, size);
+    changed_();
+  }
+
+  /*!
+    \brief Replace the values by moving \a values into the axis
+    \param values the values
+    */
+  void SharedAxis::set_values(std::vector<double> &&values)
+  {
+    values_ = std::move(values);
+    changed_();
+  }
+
+  //! Drop the cached pixels and notify the curves
+  void SharedAxis::changed_()
+  {
+    pixelsValid_ = false;
+    signal_changed();
+  }
+
+  /*!
+    \brief Return the pixel coordinates of the values [from, from + n)
+
+    The pixels are cached for the last map.  Mapping the same range
+    with the same map again, from any curve, only looks them up.
+    Ranges outside the cached one extend it, including the values in
+    between.
+
+    \param map map of the axis
+    \param from index of the first value
+    \param n number of values
+    \return pointer to n pixel coordinates, valid until the next call
+    \sa DoubleIntMap::transform(const double *, int *, int) const
+    */
+  const int *SharedAxis::pixels(const DoubleIntMap &map, int from, int n) const
+  {
+    if (!pixelsValid_ || !same_map(map, pixelsMap_))
+    {
+      pixels_.resize(values_.size());
+      pixelsMap_ = map;
+      pixelsFrom_ = pixelsTo_ = from;
+      pixelsValid_ = true;
+    }
+
+    const int to = from + n;
+    if (pixelsFrom_ == pixelsTo_)
+      pixelsFrom_ = pixelsTo_ = from;
+    if (from < pixelsFrom_)
+    {
+      map.transform(values_.data() + from, pixels_.data() + from,
+          pixelsFrom_ - from);
+      pixelsFrom_ = from;
+    }
+    if (to > pixelsTo_)
+    {
+      map.transform(values_.data() + pixelsTo_, pixels_.data() + pixelsTo_,
+          to - pixelsTo_);
+      pixelsTo_ = to;
+    }
+
+    return pixels_.data() + from;
+  }
+
+} //namespace PlotMM
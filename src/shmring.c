@@ -0,0 +1,187 @@
+/* -*- mode: C ; c-file-style: "stroustrup" -*- *******************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shmring.h"
+
+/*!
+  \brief Return the size of a sample ring in bytes
+  \param capacity number of slots
+  */
+size_t plotmm_shm_size(uint32_t capacity)
+{
+  return PLOTMM_SHM_HEADER_SIZE + 2 * sizeof(double) * (size_t)capacity;
+}
+
+/*!
+  \brief Create a sample ring, or reset an existing one of the same
+  capacity
+
+  Re-creating a ring with another capacity resizes the shared memory
+  object.  Attached readers detach in their next update, but must
+  not be drawing from the ring while it shrinks.
+
+  \param name name of the shared memory object, like "/daq0"
+  \param capacity number of slots, rounded up to a power of two of at
+  most 2^30
+  \return the writer side of the ring, or NULL on errors
+  */
+struct plotmm_shm_ring *plotmm_shm_create(const char *name, uint32_t capacity)
+{
+  struct plotmm_shm_ring *ring;
+  struct plotmm_shm_header *h;
+  struct stat st;
+  uint32_t n = 2;
+  int fd;
+  void *map;
+
+  while (n < capacity && n < (1u << 30))
+    n <<= 1;
+
+  fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+    return NULL;
+  if (fstat(fd, &st) != 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  if ((size_t)st.st_size != plotmm_shm_size(n))
+  {
+    /* tell attached readers before their samples go away */
+    if ((size_t)st.st_size >= PLOTMM_SHM_HEADER_SIZE)
+    {
+      map = mmap(NULL, PLOTMM_SHM_HEADER_SIZE, PROT_READ | PROT_WRITE,
+          MAP_SHARED, fd, 0);
+      if (map != MAP_FAILED)
+      {
+        h = (struct plotmm_shm_header *)map;
+        __atomic_store_n(&h->magic, 0, __ATOMIC_RELEASE);
+        munmap(map, PLOTMM_SHM_HEADER_SIZE);
+      }
+    }
+    if (ftruncate(fd, plotmm_shm_size(n)) != 0)
+    {
+      close(fd);
+      return NULL;
+    }
+  }
+
+  map = mmap(NULL, plotmm_shm_size(n), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  ring = (struct plotmm_shm_ring *)malloc(sizeof(*ring));
+  if (map == MAP_FAILED || !ring)
+  {
+    if (map != MAP_FAILED)
+      munmap(map, plotmm_shm_size(n));
+    free(ring);
+    close(fd);
+    return NULL;
+  }
+
+  ring->fd = fd;
+  ring->size = plotmm_shm_size(n);
+  ring->header = h = (struct plotmm_shm_header *)map;
+  ring->x = (double *)((char *)map + PLOTMM_SHM_HEADER_SIZE);
+  ring->y = ring->x + n;
+
+  /* readers of a previous writer see a reset, others a new ring */
+  if (h->magic == PLOTMM_SHM_MAGIC && h->version == PLOTMM_SHM_VERSION
+      && h->capacity == n && h->header_size == PLOTMM_SHM_HEADER_SIZE)
+    plotmm_shm_reset(ring);
+  else
+  {
+    memset(h, 0, sizeof(*h));
+    h->version = PLOTMM_SHM_VERSION;
+    h->capacity = n;
+    h->header_size = PLOTMM_SHM_HEADER_SIZE;
+    h->generation = 1;
+    __atomic_store_n(&h->magic, PLOTMM_SHM_MAGIC, __ATOMIC_RELEASE);
+  }
+  return ring;
+}
+
+/*!
+  \brief Append samples to the ring
+
+  The samples are stored before the write index is advanced, so
+  readers that load the write index find the samples below it
+  complete.  The writer does not look at readers: slots shown by a
+  reader are overwritten once the stream has moved on by the
+  capacity, see ShmSeriesData::overruns.  Only the last capacity
+  samples of a larger batch are stored.
+
+  \param ring the ring
+  \param x pointer to x values
+  \param y pointer to y values
+  \param n number of samples
+  */
+void plotmm_shm_write(struct plotmm_shm_ring *ring,
+    const double *x, const double *y, uint32_t n)
+{
+  struct plotmm_shm_header *h = ring->header;
+  const uint32_t cap = h->capacity;
+  uint64_t w = __atomic_load_n(&h->write_index, __ATOMIC_RELAXED);
+  uint32_t p, k;
+
+  if (n > cap)
+  {
+    x += n - cap;
+    y += n - cap;
+    w += n - cap;
+    n = cap;
+  }
+
+  p = (uint32_t)(w & (cap - 1));
+  k = (n < cap - p) ? n : cap - p;
+  memcpy(ring->x + p, x, k * sizeof(double));
+  memcpy(ring->y + p, y, k * sizeof(double));
+  memcpy(ring->x, x + k, (n - k) * sizeof(double));
+  memcpy(ring->y, y + k, (n - k) * sizeof(double));
+
+  __atomic_store_n(&h->write_index, w + n, __ATOMIC_RELEASE);
+}
+
+/*!
+  \brief Start a new stream, readers drop the samples they show
+
+  The write index is cleared before the generation is published, so
+  a reader that sees the new generation also sees the new stream.
+
+  \param ring the ring
+  */
+void plotmm_shm_reset(struct plotmm_shm_ring *ring)
+{
+  struct plotmm_shm_header *h = ring->header;
+  __atomic_store_n(&h->write_index, 0, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&h->generation, 1, __ATOMIC_RELEASE);
+}
+
+/*!
+  \brief Close the writer side of a ring
+  \param ring the ring
+  \param unlinkName name to remove the shared memory object with, or
+  NULL to leave it for the next writer
+  */
+void plotmm_shm_close(struct plotmm_shm_ring *ring, const char *unlinkName)
+{
+  if (!ring)
+    return;
+  munmap(ring->header, ring->size);
+  close(ring->fd);
+  if (unlinkName)
+    shm_unlink(unlinkName);
+  free(ring);
+}
@@ -0,0 +1,208 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "shmseriesdata.h"
+
+namespace PlotMM {
+
+  //! Constructor
+  ShmSeriesData::ShmSeriesData()
+    : fd_(-1), mapSize_(0), header_(0), x_(0), y_(0),
+      capacity_(0), headroom_(0), generation_(0), first_(0), count_(0),
+      overruns_(0)
+  {
+  }
+
+  //! Destructor, detaches from the ring
+  ShmSeriesData::~ShmSeriesData()
+  {
+    close();
+  }
+
+  /*!
+    \brief Attach to a sample ring
+
+    The headroom is set to a quarter of the capacity.
+
+    \param name name of the shared memory object, like "/daq0"
+    \return false if there is no valid ring of that name
+    \sa plotmm_shm_create
+    */
+  bool ShmSeriesData::open(const std::string &name)
+  {
+    close();
+
+    fd_ = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd_ < 0)
+      return false;
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd_, &st) == 0 && st.st_size >= PLOTMM_SHM_HEADER_SIZE)
+      map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+      close();
+      return false;
+    }
+    mapSize_ = st.st_size;
+    header_ = static_cast<const plotmm_shm_header *>(map);
+
+    // the magic is stored last when a ring is created
+    const uint32_t capacity = header_->capacity;
+    if (__atomic_load_n(&header_->magic, __ATOMIC_ACQUIRE) != PLOTMM_SHM_MAGIC
+        || header_->version != PLOTMM_SHM_VERSION
+        || header_->header_size != PLOTMM_SHM_HEADER_SIZE
+        || capacity < 2 || capacity > (1u << 30)
+        || (capacity & (capacity - 1)) != 0
+        || mapSize_ < plotmm_shm_size(capacity))
+    {
+      close();
+      return false;
+    }
+
+    const char *base = static_cast<const char *>(map);
+    x_ = reinterpret_cast<const double *>(base + PLOTMM_SHM_HEADER_SIZE);
+    y_ = x_ + capacity;
+    capacity_ = capacity;
+    headroom_ = capacity / 4;
+
+    if (!update())
+      signal_changed();
+    return true;
+  }
+
+  //! Detach from the ring, the series is empty afterwards
+  void ShmSeriesData::close()
+  {
+    if (header_)
+      munmap(const_cast<plotmm_shm_header *>(header_), mapSize_);
+    if (fd_ >= 0)
+      ::close(fd_);
+
+    const bool attached = header_ != 0;
+    fd_ = -1;
+    mapSize_ = 0;
+    header_ = 0;
+    x_ = y_ = 0;
+    capacity_ = headroom_ = 0;
+    generation_ = first_ = 0;
+    count_ = 0;
+    if (attached)
+      signal_changed();
+  }
+
+  /*!
+    \brief Set the number of slots kept clear for the writer
+
+    Takes effect with the next update.
+
+    \param n number of samples the writer may add during a frame
+    */
+  void ShmSeriesData::set_headroom(int n)
+  {
+    headroom_ = std::max(0, std::min(n, capacity_ - 1));
+  }
+
+  /*!
+    \brief Serve the most recent samples of the ring
+
+    Emits signal_changed if other samples are served now.  An update
+    that races with a reset by the writer is skipped.  If the writer
+    has overwritten samples served since the last update, an overrun
+    is counted.  If the ring was re-created with another capacity,
+    the series detaches from it.
+
+    \sa SeriesData::update
+    */
+  bool ShmSeriesData::update()
+  {
+    if (!header_)
+      return false;
+
+    // cleared by a writer that is about to resize the ring
+    if (__atomic_load_n(&header_->magic, __ATOMIC_ACQUIRE) != PLOTMM_SHM_MAGIC
+        || header_->capacity != static_cast<uint32_t>(capacity_))
+    {
+      close();
+      return true;
+    }
+
+    const uint64_t g1 = __atomic_load_n(&header_->generation, __ATOMIC_ACQUIRE);
+    const uint64_t w = __atomic_load_n(&header_->write_index, __ATOMIC_ACQUIRE);
+    const uint64_t g2 = __atomic_load_n(&header_->generation, __ATOMIC_ACQUIRE);
+    if (g1 != g2)
+      return false;
+
+    // sample first_ is overwritten by the write of first_ + capacity_
+    if (g1 == generation_ && count_ > 0 && w > first_ + capacity_)
+      overruns_++;
+
+    const int count = std::min<uint64_t>(w, capacity_ - headroom_);
+    const uint64_t first = w - count;
+    if (g1 == generation_ && first == first_ && count == count_)
+      return false;
+
+    generation_ = g1;
+    first_ = first;
+    count_ = count;
+    signal_changed();
+    return true;
+  }
+
+  //! Return the number of samples served
+  int ShmSeriesData::size() const
+  {
+    return count_;
+  }
+
+  //! \copydoc SeriesData::fetch
+  void ShmSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    const double *xs, *ys;
+    for (int k; n > 0; n -= k, from += k, x += k, y += k)
+    {
+      k = span(from, n, xs, ys);
+      std::copy(xs, xs + k, x);
+      std::copy(ys, ys + k, y);
+    }
+  }
+
+  /*!
+    \brief Give direct access to the shared pages
+
+    Returns fewer than \a n samples where the ring wraps around.
+    \sa SeriesData::span
+    */
+  int ShmSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    const size_t p = slot_(from);
+    x = x_ + p;
+    y = y_ + p;
+    return std::min<size_t>(n, capacity_ - p);
+  }
+
+  //! Return the x value of sample \a i
+  double ShmSeriesData::x(int i) const
+  {
+    return x_[slot_(i)];
+  }
+
+  //! Return the y value of sample \a i
+  double ShmSeriesData::y(int i) const
+  {
+    return y_[slot_(i)];
+  }
+
+} //namespace PlotMM
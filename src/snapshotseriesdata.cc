@@ -0,0 +1,162 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "supplemental.h"
+#include "snapshotseriesdata.h"
+
+namespace PlotMM {
+
+  //! Constructor, the series is empty until the first update
+  SnapshotSeriesData::SnapshotSeriesData()
+    : current_(new Snapshot), latest_(0), spare_(0)
+  {
+    current_->valid = false;
+    current_->mono = 0;
+  }
+
+  //! Destructor
+  SnapshotSeriesData::~SnapshotSeriesData()
+  {
+    delete current_;
+    delete latest_.load();
+    delete spare_.load();
+  }
+
+  /*!
+    \brief Publish a copy of samples, called by writer threads
+    \param x pointer to x values
+    \param y pointer to y values
+    \param size number of samples
+    */
+  void SnapshotSeriesData::publish(const double *x, const double *y, int size)
+  {
+    Snapshot *s = acquire_();
+    s->x.assign(x, x + std::max(size, 0));
+    s->y.assign(y, y + std::max(size, 0));
+    publish_(s);
+  }
+
+  /*!
+    \brief Publish samples without copying them, called by writer
+    threads
+
+    The shorter array determines the number of samples.
+    */
+  void SnapshotSeriesData::publish(std::vector<double> &&x,
+      std::vector<double> &&y)
+  {
+    Snapshot *s = acquire_();
+    s->x.swap(x);
+    s->y.swap(y);
+    const size_t size = std::min(s->x.size(), s->y.size());
+    s->x.resize(size);
+    s->y.resize(size);
+    publish_(s);
+  }
+
+  //! Return a retired snapshot for reuse, or a new one
+  SnapshotSeriesData::Snapshot *SnapshotSeriesData::acquire_()
+  {
+    Snapshot *s = spare_.exchange(0, std::memory_order_acquire);
+    return s ? s : new Snapshot;
+  }
+
+  //! Derive the bounds and publish \a s, replacing what was not picked up
+  void SnapshotSeriesData::publish_(Snapshot *s)
+  {
+    const int size = s->x.size();
+    s->valid = array_bounds(s->x.data(), s->y.data(), size,
+        s->xmin, s->xmax, s->ymin, s->ymax);
+    s->mono = check_mono(s->x.data(), size);
+
+    Snapshot *old = latest_.exchange(s, std::memory_order_acq_rel);
+    if (old)
+      recycle_(old);
+  }
+
+  //! Offer \a s for reuse, dropping it if there is a spare already
+  void SnapshotSeriesData::recycle_(Snapshot *s)
+  {
+    Snapshot *old = spare_.exchange(s, std::memory_order_acq_rel);
+    delete old;
+  }
+
+  /*!
+    \brief Pick up the latest snapshot, called by the GUI thread
+
+    The previous snapshot is retired and signal_changed is emitted.
+    \sa SeriesData::update
+    */
+  bool SnapshotSeriesData::update()
+  {
+    Snapshot *s = latest_.exchange(0, std::memory_order_acq_rel);
+    if (!s)
+      return false;
+
+    recycle_(current_);
+    current_ = s;
+    signal_changed();
+    return true;
+  }
+
+  //! Return the number of samples in the current snapshot
+  int SnapshotSeriesData::size() const
+  {
+    return current_->x.size();
+  }
+
+  //! \copydoc SeriesData::fetch
+  void SnapshotSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    std::copy(current_->x.begin() + from, current_->x.begin() + from + n, x);
+    std::copy(current_->y.begin() + from, current_->y.begin() + from + n, y);
+  }
+
+  /*!
+    \brief Give direct access to the current snapshot
+    \sa SeriesData::span
+    */
+  int SnapshotSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    x = current_->x.data() + from;
+    y = current_->y.data() + from;
+    return n;
+  }
+
+  //! Return the x value of sample \a i
+  double SnapshotSeriesData::x(int i) const
+  {
+    return current_->x[i];
+  }
+
+  //! Return the y value of sample \a i
+  double SnapshotSeriesData::y(int i) const
+  {
+    return current_->y[i];
+  }
+
+  //! Return the bounds the writer computed
+  bool SnapshotSeriesData::bounds(double &xmin, double &xmax,
+      double &ymin, double &ymax) const
+  {
+    xmin = current_->xmin;
+    xmax = current_->xmax;
+    ymin = current_->ymin;
+    ymax = current_->ymax;
+    return current_->valid;
+  }
+
+  //! Return the monotony the writer computed
+  int SnapshotSeriesData::monotonic() const
+  {
+    return current_->mono;
+  }
+
+} //namespace PlotMM
@@ -0,0 +1,75 @@
+/* -*- mode: C++ ; c-file-style: "stroustrup" -*- *****************************
+ * PlotMM Widget Library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the LGPL
+ *****************************************************************************/
+
+#include <algorithm>
+
+#include "stridedseriesdata.h"
+
+namespace PlotMM {
+
+  /*!
+    \brief Constructor
+    \param x view of the x values
+    \param y view of the y values
+    \param release called when the series is destroyed
+    */
+  StridedSeriesData::StridedSeriesData(const StridedArray &x,
+      const StridedArray &y, const sigc::slot<void> &release)
+    : x_(x), y_(y), release_(release)
+  {
+  }
+
+  //! Destructor, calls the release slot
+  StridedSeriesData::~StridedSeriesData()
+  {
+    if (!release_.empty())
+      release_();
+  }
+
+  //! Return the number of samples, the size of the shorter view
+  int StridedSeriesData::size() const
+  {
+    return std::min(x_.size(), y_.size());
+  }
+
+  //! \copydoc SeriesData::fetch
+  void StridedSeriesData::fetch(int from, int n, double *x, double *y) const
+  {
+    x_.copy(from, n, x);
+    y_.copy(from, n, y);
+  }
+
+  /*!
+    \brief Give direct access to consecutive samples
+
+    Only possible if both views are contiguous.
+    \sa SeriesData::span
+    */
+  int StridedSeriesData::span(int from, int n,
+      const double *&x, const double *&y) const
+  {
+    if (!x_.contiguous() || !y_.contiguous())
+      return 0;
+
+    x = x_.data() + from;
+    y = y_.data() + from;
+    return std::min(n, size() - from);
+  }
+
+  //! Return the x value of sample \a i
+  double StridedSeriesData::x(int i) const
+  {
+    return x_[i];
+  }
+
+  //! Return the y value of sample \a i
+  double StridedSeriesData::y(int i) const
+  {
+    return y_[i];
+  }
+
+} //namespace PlotMM
@@ -7,6 +7,16 @@
  *****************************************************************************/
 /* ported from qwt */
 
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PLOTMM_AVX_DISPATCH 1
+#endif
+
 #include "supplemental.h"
 
 namespace PlotMM {
@@ -14,39 +24,183 @@ namespace PlotMM {
   const double LogMin = 1.0e-150;
   const double LogMax = 1.0e150;
 
+  namespace {
+
+    typedef void (*MinMaxKernel)(const double *, int, double *, double *);
+
+    /* min/max of an array, NaN values are skipped.  The extremes are
+       merged into *mn and *mx.  Reference implementation and tail
+       handler for the SIMD kernels. */
+    void min_max_scalar(const double *a, int n, double *mn, double *mx)
+    {
+      double lo = *mn, hi = *mx;
+      for (int i = 0; i < n; i++)
+      {
+        if (a[i] < lo) lo = a[i];
+        if (a[i] > hi) hi = a[i];
+      }
+      *mn = lo;
+      *mx = hi;
+    }
+
+#if defined(__SSE2__)
+    void min_max_sse2(const double *a, int n, double *mn, double *mx)
+    {
+      // minpd/maxpd return the second operand if either one is NaN,
+      // so NaN samples never replace the accumulated extremes
+      __m128d lo0 = _mm_set1_pd(*mn), lo1 = lo0;
+      __m128d hi0 = _mm_set1_pd(*mx), hi1 = hi0;
+      int i = 0;
+      for (; i + 4 <= n; i += 4)
+      {
+        const __m128d v0 = _mm_loadu_pd(a + i);
+        const __m128d v1 = _mm_loadu_pd(a + i + 2);
+        lo0 = _mm_min_pd(v0, lo0); hi0 = _mm_max_pd(v0, hi0);
+        lo1 = _mm_min_pd(v1, lo1); hi1 = _mm_max_pd(v1, hi1);
+      }
+      double l[2], h[2];
+      _mm_storeu_pd(l, _mm_min_pd(lo0, lo1));
+      _mm_storeu_pd(h, _mm_max_pd(hi0, hi1));
+      *mn = std::min(l[0], l[1]);
+      *mx = std::max(h[0], h[1]);
+      min_max_scalar(a + i, n - i, mn, mx);
+    }
+#endif
+
+#if defined(PLOTMM_AVX_DISPATCH)
+    __attribute__((target("avx")))
+    void min_max_avx(const double *a, int n, double *mn, double *mx)
+    {
+      __m256d lo0 = _mm256_set1_pd(*mn), lo1 = lo0;
+      __m256d hi0 = _mm256_set1_pd(*mx), hi1 = hi0;
+      int i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        const __m256d v0 = _mm256_loadu_pd(a + i);
+        const __m256d v1 = _mm256_loadu_pd(a + i + 4);
+        lo0 = _mm256_min_pd(v0, lo0); hi0 = _mm256_max_pd(v0, hi0);
+        lo1 = _mm256_min_pd(v1, lo1); hi1 = _mm256_max_pd(v1, hi1);
+      }
+      double l[4], h[4];
+      _mm256_storeu_pd(l, _mm256_min_pd(lo0, lo1));
+      _mm256_storeu_pd(h, _mm256_max_pd(hi0, hi1));
+      *mn = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+      *mx = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+      min_max_scalar(a + i, n - i, mn, mx);
+    }
+#endif
+
+    MinMaxKernel select_min_max_kernel()
+    {
+#if defined(PLOTMM_AVX_DISPATCH)
+      // may run before the CPU model is set up by libgcc
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx"))
+        return min_max_avx;
+#endif
+#if defined(__SSE2__)
+      return min_max_sse2;
+#else
+      return min_max_scalar;
+#endif
+    }
+
+    /* Min and max of an array with the best kernel for the CPU,
+       chosen on first use so static constructors can call it */
+    void min_max_kernel(const double *a, int n, double *mn, double *mx)
+    {
+      static const MinMaxKernel kernel = select_min_max_kernel();
+      kernel(a, n, mn, mx);
+    }
+
+    // x and y are scanned in blocks of this size, so both arrays are
+    // read in one pass while the accumulators stay in registers
+    const int MinMaxBlock = 2048;
+
+  }
+
   /*!
-    \brief Find the smallest value in an array
+    \brief Find the smallest and the largest value in an array
+
+    NaN values are skipped.  The array is scanned once with SSE2 or,
+    if the CPU supports it, AVX instructions.
+
     \param array Pointer to an array
     \param size Array size
+    \param min Smallest value
+    \param max Largest value
+    \return false if the array contains no value that is not NaN.
+    min and max are set to 0.0 in this case.
     */
-  double array_min(double *array, int size)
+  bool array_min_max(const double *array, int size, double &min, double &max)
   {
-    if (size <= 0)
-      return 0.0;
+    min = HUGE_VAL;
+    max = -HUGE_VAL;
+    if (size > 0)
+      min_max_kernel(array, size, &min, &max);
 
-    double rv = array[0];
-    for (int i = 1; i < size; i++)
-      rv = std::min(rv, array[i]);
-
-    return rv;
+    if (min > max)
+    {
+      min = max = 0.0;
+      return false;
+    }
+    return true;
   }
 
+  /*!
+    \brief Find the bounds of a set of points in a single pass
+
+    Both arrays are scanned together, block by block, with the same
+    kernels as array_min_max().  NaN values are skipped.
+
+    \param x Pointer to the x values
+    \param y Pointer to the y values
+    \param size Size of both arrays
+    \param xmin Smallest x value
+    \param xmax Largest x value
+    \param ymin Smallest y value
+    \param ymax Largest y value
+    \return false if x or y contain no value that is not NaN
+    */
+  bool array_bounds(const double *x, const double *y, int size,
+      double &xmin, double &xmax, double &ymin, double &ymax)
+  {
+    xmin = ymin = HUGE_VAL;
+    xmax = ymax = -HUGE_VAL;
+    for (int i = 0; i < size; i += MinMaxBlock)
+    {
+      const int n = std::min(MinMaxBlock, size - i);
+      min_max_kernel(x + i, n, &xmin, &xmax);
+      min_max_kernel(y + i, n, &ymin, &ymax);
+    }
+    return xmin <= xmax && ymin <= ymax;
+  }
 
   /*!
-    \brief Find the largest value in an array
+    \brief Find the smallest value in an array
     \param array Pointer to an array
     \param size Array size
+    \sa array_min_max
     */
-  double array_max(double *array, int size)
+  double array_min(const double *array, int size)
   {
-    if (size <= 0)
-      return 0.0;
+    double mn, mx;
+    array_min_max(array, size, mn, mx);
+    return mn;
+  }
 
-    double rv = array[0];
-    for (int i = 1; i < size; i++)
-      rv = std::max(rv, array[i]);
 
-    return rv;
+  /*!
+    \brief Find the largest value in an array
+    \param array Pointer to an array
+    \param size Array size
+    \sa array_min_max
+    */
+  double array_max(const double *array, int size)
+  {
+    double mn, mx;
+    array_min_max(array, size, mn, mx);
+    return mx;
   }
 
 
@@ -119,7 +273,7 @@ namespace PlotMM {
     <dt>-1<dd>sequence is strictly monotonically decreasing
     </dl>
     */
-  int check_mono(double *array, int size)
+  int check_mono(const double *array, int size)
   {
     if (size < 2)
       return 0;
@@ -278,4 +432,23 @@ namespace PlotMM {
       array.push_back(c[i]);
   }
 
+  /*!
+    \brief Take the natural logarithm of every array element
+
+    Non-positive values are replaced by LogMin in a separate,
+    branch-free pass before the logarithm is taken, the same limit
+    DoubleIntMap applies to logarithmic intervals.
+
+    \param array input values
+    \param out where to put the logarithms, may be equal to array
+    \param size size of the arrays
+    */
+  void log_array(const double *array, double *out, int size)
+  {
+    for (int i = 0; i < size; i++)
+      out[i] = std::max(array[i], LogMin);
+    for (int i = 0; i < size; i++)
+      out[i] = log(out[i]);
+  }
+
 } // namespace PlotMM